@@ -7,15 +7,37 @@
  * https://opensource.org/licenses/MIT
  */
 
+#include <cctype>
+#include <cerrno>
+#include <cstddef>
 #include <cstdio>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <limits>
 #include <vector>
 #include <map>
+#include <unordered_set>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
 #include <regex>
 #include <stdexcept>
+#if defined(__unix__) || defined(__APPLE__)
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+#endif
 
 #ifndef __ARGPARSE_H_INCLUDE
 #define __ARGPARSE_H_INCLUDE
@@ -24,6 +46,24 @@
 namespace argparse {
   using std::regex_constants::icase;
 
+#ifdef ARGPARSE_COUNT_WORK
+  /**
+   * @brief The number of the steps taken by the parsers.
+   *
+   * A step is a probe, a compared byte, or a processed element. This is
+   * defined only for the tests, which bound the work instead of the time.
+   */
+  inline uint64_t&
+  work_counter(void)
+  {
+    static uint64_t steps(0);
+    return steps;
+  }
+#define ARGPARSE_WORK(n) (::argparse::work_counter() += (n))
+#else
+#define ARGPARSE_WORK(n) ((void)0)
+#endif
+
   /** Indicator of "Variable Arguments" */
   constexpr int16_t variable_args = -1;
 
@@ -32,6 +72,14 @@ namespace argparse {
   /** An array of string elements */
   typedef std::vector<argparse::arg> args;
 
+  /**
+   * @brief Directions in which a scoped option is bound to its anchor.
+   */
+  enum class scope_type {
+    Next,    /**< Bound to the next occurrence of the anchor */
+    Previous /**< Bound to the previous occurrence of the anchor */
+  };
+
   /**
    * @brief Types of values recognized by Argument Parser.
    */
@@ -43,6 +91,60 @@ namespace argparse {
     String   /**< String type */
   };
 
+  /**
+   * @brief Convert an element into an integer as `std::stol` does.
+   * @param[in] s The element.
+   * @param[out] v The converted value.
+   * @return False if not convertible.
+   */
+  inline bool
+  scan_integer(const char* s, int64_t& v)
+  {
+    char* end;
+    errno = 0;
+    v = std::strtoll(s, &end, 10);
+    return (end != s && errno != ERANGE);
+  }
+
+  /**
+   * @brief Convert an element into a float as `std::stod` does.
+   * @param[in] s The element.
+   * @param[out] v The converted value.
+   * @return False if not convertible.
+   */
+  inline bool
+  scan_float(const char* s, double& v)
+  {
+    char* end;
+    errno = 0;
+    v = std::strtod(s, &end);
+    return (end != s && errno != ERANGE);
+  }
+
+  /**
+   * @brief Convert an element into a boolean.
+   * @param[in] s The element: `true` or `false` in any case, or an integer.
+   * @param[out] v The converted value.
+   * @return False if not convertible.
+   */
+  inline bool
+  scan_bool(const char* s, bool& v)
+  {
+    /** A case-insensitive comparison without building a regex */
+    auto match = [s] (const char* word) {
+      size_t i(0);
+      for (; word[i] != '\0'; i++)
+        if (std::tolower((unsigned char)s[i]) != word[i]) return false;
+      return (s[i] == '\0');
+    };
+    int64_t x;
+    if (match("true")) v = true;
+    else if (match("false")) v = false;
+    else if (scan_integer(s, x)) v = (x != 0);
+    else return false;
+    return true;
+  }
+
   /**
    * @brief A container of an element.
    *
@@ -74,6 +176,12 @@ namespace argparse {
      */
     const value_type& type(void) const { return _type; }
 
+    /**
+     * @brief Return the value in a form of C++-type string.
+     * @return The reference to the string given to the container.
+     */
+    const arg& str(void) const { return _value; }
+
     /**
      * @brief Return the current `value_type` as a text.
      * @return A C-type text explaining the current `value_type`.
@@ -100,7 +208,7 @@ namespace argparse {
      * element is assigned.
      */
     value& operator=(const char* c) {
-      _value = arg(c);
+      _value = c;
       assert_argument_type();
       return *this;
     }
@@ -114,67 +222,75 @@ namespace argparse {
      * and `std::string`.
      * @exception std::runtime_error is thrown if the type is wrong.
      */
-    template <class T> const T get(void) const;
+    template <class T> const T get(void) const
+    { return parse<T>(_value.c_str()); }
+
+    /**
+     * @brief Convert an element into a requested type without a copy.
+     * @tparam T A type of the element, as in `get()`.
+     * @param[in] s The element in a C-type string.
+     * @exception std::runtime_error is thrown if not convertible.
+     */
+    template <class T> static T parse(const char* s);
   private:
     value_type _type;  /**< The type of the value */
     arg _value;        /**< The value in a C++-type string */
     /** Check wheather the value is convertible to the requested type  */
     void assert_argument_type(void) const;
-    /** Convert the value into Bool */
-    const bool convert_bool(void) const;
-    /** Convert the value into Integer */
-    const int64_t convert_integer(void) const;
-    /** Convert the value into Float */
-    const double convert_float(void) const;
-    /** Convert the value into String */
-    const arg convert_string(void) const;
+    /** Convert an element into Bool */
+    static bool parse_bool(const char* s);
+    /** Convert an element into Integer */
+    static int64_t parse_integer(const char* s);
+    /** Convert an element into Float */
+    static double parse_float(const char* s);
   };
 
   template <> inline
-  const bool value::get<bool>(void) const {
-    return convert_bool();
+  bool value::parse<bool>(const char* s) {
+    return parse_bool(s);
   }
   template <> inline
-  const int16_t value::get<int16_t>(void) const {
-    return (int16_t)convert_integer();
+  int16_t value::parse<int16_t>(const char* s) {
+    return (int16_t)parse_integer(s);
   }
   template <> inline
-  const int32_t value::get<int32_t>(void) const {
-    return (int32_t)convert_integer();
+  int32_t value::parse<int32_t>(const char* s) {
+    return (int32_t)parse_integer(s);
   }
   template <> inline
-  const int64_t value::get<int64_t>(void) const {
-    return convert_integer();
+  int64_t value::parse<int64_t>(const char* s) {
+    return parse_integer(s);
   }
   template <> inline
-  const uint16_t value::get<uint16_t>(void) const {
-    return (uint16_t)convert_integer();
+  uint16_t value::parse<uint16_t>(const char* s) {
+    return (uint16_t)parse_integer(s);
   }
   template <> inline
-  const uint32_t value::get<uint32_t>(void) const {
-    return (uint32_t)convert_integer();
+  uint32_t value::parse<uint32_t>(const char* s) {
+    return (uint32_t)parse_integer(s);
   }
   template <> inline
-  const uint64_t value::get<uint64_t>(void) const {
-    return (uint64_t)convert_integer();
+  uint64_t value::parse<uint64_t>(const char* s) {
+    return (uint64_t)parse_integer(s);
   }
   template <> inline
-  const float value::get<float>(void) const {
-    return convert_float();
+  float value::parse<float>(const char* s) {
+    return parse_float(s);
   }
   template <> inline
-  const double value::get<double>(void) const {
-    return convert_float();
+  double value::parse<double>(const char* s) {
+    return parse_float(s);
   }
   template <> inline
-  const arg value::get<arg>(void) const {
-    return convert_string();
+  arg value::parse<arg>(const char* s) {
+    return arg(s);
   }
 
   const char*
   value::describe_type(void) const
   {
     switch (_type) {
+    case value_type::Bool    : return "bool"; break;
     case value_type::Integer : return "integer"; break;
     case value_type::Float   : return "float"; break;
     case value_type::String  : return "string"; break;
@@ -190,65 +306,47 @@ namespace argparse {
       throw std::runtime_error("argument type is null.");
       break;
     case value_type::Bool :
-      convert_bool();
+      parse_bool(_value.c_str());
       break;
     case value_type::Integer :
-      convert_integer();
+      parse_integer(_value.c_str());
       break;
     case value_type::Float   :
-      convert_float();
+      parse_float(_value.c_str());
       break;
     case value_type::String  :
-      convert_string();
+      /** any string is acceptable and no copy is required */
       break;
     default:
       throw std::runtime_error("wrong argument type is set.");
     }
   }
 
-  const bool
-  value::convert_bool(void) const
+  bool
+  value::parse_bool(const char* s)
   {
-    if (std::regex_match(_value, std::regex("true", icase))) {
-      return true;
-    } else if (std::regex_match(_value, std::regex("false", icase))) {
-      return false;
-    } else {
-      try {
-        return (std::stol(_value) != 0);
-      } catch (std::exception& e) {
-        throw std::runtime_error("value is not convertible to boolean-type");
-      }
-    }
+    bool v;
+    if (!scan_bool(s, v))
+      throw std::runtime_error("value is not convertible to boolean-type");
+    return v;
   }
 
-  const int64_t
-  value::convert_integer(void) const
+  int64_t
+  value::parse_integer(const char* s)
   {
-    try {
-      return std::stol(_value);
-    } catch (std::exception& e) {
+    int64_t v;
+    if (!scan_integer(s, v))
       throw std::runtime_error("value is not convertible to integer-type");
-    }
-  }
-  const double
-  value::convert_float(void) const
-  {
-    try {
-      return std::stod(_value);
-    } catch (std::exception& e) {
-      throw std::runtime_error("value is not convertible to float-type");
-    }
+    return v;
   }
 
-  const arg
-  value::convert_string(void) const
+  double
+  value::parse_float(const char* s)
   {
-    try {
-      return _value;
-    } catch (std::exception& e) {
-      throw std::runtime_error("value is not convertible to string-type");
-    }
+    double v;
+    if (!scan_float(s, v))
+      throw std::runtime_error("value is not convertible to float-type");
+    return v;
   }
 
   /**
@@ -325,6 +423,7 @@ namespace argparse {
   abstract_argument::describe_type(void) const
   {
     switch (_type) {
+    case value_type::Bool    : return "bool"; break;
     case value_type::Integer : return "integer"; break;
     case value_type::Float   : return "float"; break;
     case value_type::String  : return "string"; break;
@@ -635,6 +734,372 @@ namespace argparse {
   /** A pair of argparse::arg and argparse::values */
   typedef std::pair<arg,values> argument;
 
+  /** The header of a snapshot of parsed values */
+  struct snapshot_header {
+    char magic[4];     /**< The magic bytes "ARGP" */
+    uint32_t version;  /**< The version of the layout */
+    uint32_t size;     /**< The total size in bytes */
+    uint32_t nentries; /**< The number of the entries */
+    uint32_t nvalues;  /**< The number of the values */
+  };
+
+  /** An entry of a snapshot of parsed values */
+  struct snapshot_entry {
+    uint32_t name;     /**< The offset of the name */
+    uint32_t type;     /**< The `value_type` of the values */
+    uint32_t first;    /**< The index of the first value */
+    uint32_t count;    /**< The number of the values */
+  };
+
+  /** The header of a cache file of registered arguments */
+  struct spec_cache_header {
+    char magic[4];     /**< The magic bytes "ARGS" */
+    uint32_t version;  /**< The version of the layout */
+    uint64_t key;      /**< The hash of the key and the fingerprint */
+    uint32_t size;     /**< The total size in bytes */
+    uint32_t nwords;   /**< The number of the words of the records */
+    uint32_t noptions; /**< The number of the options */
+    uint32_t npositionals; /**< The number of the positional arguments */
+    uint32_t nslots;   /**< The number of the names */
+    uint32_t ndirectives; /**< The number of the directives */
+    uint32_t npresets; /**< The number of the presets */
+    uint32_t description; /**< The offset of the description */
+  };
+
+  /** The header of a record of an invocation, followed by a snapshot */
+  struct record_header {
+    char magic[4];     /**< The magic bytes "ARGL" */
+    uint32_t version;  /**< The version of the layout */
+    uint32_t size;     /**< The total size in bytes */
+    int32_t status;    /**< The exit status of the invocation */
+    uint64_t fingerprint; /**< The fingerprint of the arguments */
+    int64_t timestamp; /**< The time of the record in nanoseconds */
+    int64_t pid;       /**< The process ID of the invocation */
+  };
+
+  /**
+   * @brief Calculate the 64-bit FNV-1a hash of a byte sequence.
+   * @param[in] data The beginning of the sequence.
+   * @param[in] n The number of the bytes.
+   * @param[in] h The hash of the preceding sequence, if any.
+   * @return The hash value.
+   */
+  inline uint64_t
+  fnv1a(const void* data, const size_t n,
+        uint64_t h = 0xcbf29ce484222325ULL)
+  {
+    auto p = static_cast<const unsigned char*>(data);
+    for (size_t i=0; i<n; i++) {
+      h ^= p[i];
+      h *= 0x100000001b3ULL;
+    }
+    return h;
+  }
+
+  /**
+   * @brief A command line stored in a contiguous buffer.
+   *
+   * This class holds NUL-terminated elements in a single buffer and a
+   * null-terminated array of pointers to them. The array is available as
+   * `argv` of `execv()` as it is. The buffers are reused when the instance
+   * is filled again.
+   */
+  class argv_buffer {
+  public:
+    argv_buffer(void) {}
+    argv_buffer(const argv_buffer&) = delete;
+    argv_buffer& operator=(const argv_buffer&) = delete;
+    argv_buffer(argv_buffer&&) = default;
+    argv_buffer& operator=(argv_buffer&&) = default;
+
+    /**
+     * @brief Return the number of the elements.
+     * @return The number of the elements including the application name.
+     */
+    int argc(void) const
+    { return _pointers.empty()?0:(int)_pointers.size()-1; }
+
+    /**
+     * @brief Return the array of the elements.
+     * @return A null-terminated array of pointers to the elements.
+     */
+    char* const* argv(void) const { return _pointers.data(); }
+  private:
+    friend class argparse;
+    std::vector<char> _buffer;    /**< The NUL-terminated elements */
+    std::vector<char*> _pointers; /**< The pointers to the elements */
+  };
+
+  /**
+   * @brief A minimal read-only JSON document.
+   *
+   * This class parses a JSON text into an array of nodes. The children of
+   * an array or an object are stored contiguously, so that the number of
+   * the elements is known before they are visited. The members of an
+   * object are stored as pairs of a key and a value.
+   */
+  class json_document {
+  public:
+    /** Types of JSON nodes */
+    enum class kind : uint8_t { Null, Bool, Number, String, Array, Object };
+    /** A node of a JSON document */
+    struct node {
+      kind type;     /**< The type of the node */
+      arg text;      /**< The text of a scalar */
+      size_t first;  /**< The first child in the links */
+      size_t count;  /**< The number of the children */
+    };
+
+    /**
+     * @brief Parse a JSON text.
+     * @param[in] text The JSON text.
+     * @exception std::runtime_error is thrown if the text is malformed.
+     */
+    json_document(const arg& text);
+
+    /** Return the root node */
+    const node& root(void) const { return _nodes[_root]; }
+    /** Return the i-th child of an array, or the i-th key of an object */
+    const node& child(const node& n, const size_t i) const
+    { return _nodes[_links[n.first+i]]; }
+    /** Return the number of the elements of an array or an object */
+    size_t size(const node& n) const
+    { return (n.type == kind::Object)?n.count/2:n.count; }
+    /**
+     * @brief Find a member of an object.
+     * @return The value of the member, or `nullptr` if not found.
+     */
+    const node* member(const node& n, const char* key) const;
+  private:
+    const arg& _text;             /**< The text being parsed */
+    size_t _p;                    /**< The current position in the text */
+    size_t _root;                 /**< The index of the root node */
+    std::vector<node> _nodes;     /**< The array of the nodes */
+    std::vector<size_t> _links;   /**< The children of the nodes */
+
+    /** Throw an exception at the current position */
+    void fail(const char* what) const;
+    /** Skip white spaces */
+    void skip(void);
+    /** Parse a value and return its node */
+    size_t parse_value(const size_t depth);
+    /** Parse a string literal */
+    arg parse_string(void);
+  };
+
+  json_document::json_document(const arg& text)
+    : _text(text),_p(0),_root(0)
+  {
+    _root = parse_value(0);
+    skip();
+    if (_p != _text.size()) fail("trailing characters");
+  }
+
+  void
+  json_document::fail(const char* what) const
+  {
+    throw std::runtime_error(arg("malformed schema: ") + what
+                             + " at offset " + std::to_string(_p) + ".");
+  }
+
+  void
+  json_document::skip(void)
+  {
+    while (_p < _text.size() && std::isspace((unsigned char)_text[_p])) _p++;
+  }
+
+  const json_document::node*
+  json_document::member(const node& n, const char* key) const
+  {
+    if (n.type != kind::Object) return nullptr;
+    for (size_t i=0; i<n.count; i+=2)
+      if (_nodes[_links[n.first+i]].text == key)
+        return &_nodes[_links[n.first+i+1]];
+    return nullptr;
+  }
+
+  arg
+  json_document::parse_string(void)
+  {
+    arg s;
+    _p++;
+    while (_p < _text.size() && _text[_p] != '"') {
+      char c = _text[_p++];
+      if ((unsigned char)c < 0x20) fail("control character in a string");
+      if (c != '\\') { s += c; continue; }
+      if (_p >= _text.size()) break;
+      c = _text[_p++];
+      switch (c) {
+      case '"': case '\\': case '/': s += c; break;
+      case 'b': s += '\b'; break;
+      case 'f': s += '\f'; break;
+      case 'n': s += '\n'; break;
+      case 'r': s += '\r'; break;
+      case 't': s += '\t'; break;
+      case 'u': {
+        auto hex = [this] (void) {
+          if (_p+4 > _text.size()) fail("invalid escape");
+          uint32_t u(0);
+          for (int i=0; i<4; i++) {
+            const char h = _text[_p++];
+            u <<= 4;
+            if (h >= '0' && h <= '9') u |= h-'0';
+            else if (h >= 'a' && h <= 'f') u |= h-'a'+10;
+            else if (h >= 'A' && h <= 'F') u |= h-'A'+10;
+            else fail("invalid escape");
+          }
+          return u;
+        };
+        uint32_t u = hex();
+        if (u >= 0xD800 && u < 0xDC00 && _p+1 < _text.size()
+            && _text[_p] == '\\' && _text[_p+1] == 'u') {
+          _p += 2;
+          u = 0x10000 + ((u-0xD800)<<10) + (hex()-0xDC00);
+        }
+        /** The code point is encoded in UTF-8. */
+        if (u < 0x80) {
+          s += (char)u;
+        } else if (u < 0x800) {
+          s += (char)(0xC0|(u>>6));
+          s += (char)(0x80|(u&0x3F));
+        } else if (u < 0x10000) {
+          s += (char)(0xE0|(u>>12));
+          s += (char)(0x80|((u>>6)&0x3F));
+          s += (char)(0x80|(u&0x3F));
+        } else {
+          s += (char)(0xF0|(u>>18));
+          s += (char)(0x80|((u>>12)&0x3F));
+          s += (char)(0x80|((u>>6)&0x3F));
+          s += (char)(0x80|(u&0x3F));
+        }
+        break;
+      }
+      default: fail("invalid escape");
+      }
+    }
+    if (_p >= _text.size()) fail("unterminated string");
+    _p++;
+    return s;
+  }
+
+  size_t
+  json_document::parse_value(const size_t depth)
+  {
+    if (depth > 64) fail("too deeply nested");
+    skip();
+    if (_p >= _text.size()) fail("unexpected end");
+    node n{kind::Null, arg(), 0, 0};
+    const char c = _text[_p];
+    if (c == '{' || c == '[') {
+      /** The children are collected and linked contiguously. */
+      const char close = (c == '{')?'}':']';
+      std::vector<size_t> children;
+      n.type = (c == '{')?kind::Object:kind::Array;
+      _p++;
+      skip();
+      if (_p < _text.size() && _text[_p] == close) {
+        _p++;
+      } else {
+        while (true) {
+          skip();
+          if (n.type == kind::Object) {
+            if (_p >= _text.size() || _text[_p] != '"') fail("expected a key");
+            _nodes.push_back(node{kind::String, parse_string(), 0, 0});
+            children.push_back(_nodes.size()-1);
+            skip();
+            if (_p >= _text.size() || _text[_p] != ':') fail("expected ':'");
+            _p++;
+          }
+          children.push_back(parse_value(depth+1));
+          skip();
+          if (_p < _text.size() && _text[_p] == ',') { _p++; continue; }
+          if (_p < _text.size() && _text[_p] == close) { _p++; break; }
+          fail("expected ',' or a closing bracket");
+        }
+      }
+      n.first = _links.size();
+      n.count = children.size();
+      _links.insert(_links.end(), children.begin(), children.end());
+    } else if (c == '"') {
+      n.type = kind::String;
+      n.text = parse_string();
+    } else if (_text.compare(_p, 4, "true") == 0
+               || _text.compare(_p, 5, "false") == 0) {
+      n.type = kind::Bool;
+      n.text = (c == 't')?"true":"false";
+      _p += n.text.size();
+    } else if (_text.compare(_p, 4, "null") == 0) {
+      _p += 4;
+    } else if (c == '-' || std::isdigit((unsigned char)c)) {
+      const size_t b = _p;
+      while (_p < _text.size()
+             && std::strchr("+-.eE0123456789", _text[_p]) != nullptr) _p++;
+      n.type = kind::Number;
+      n.text = _text.substr(b, _p-b);
+    } else {
+      fail("unexpected character");
+    }
+    _nodes.push_back(n);
+    return _nodes.size()-1;
+  }
+
+  /**
+   * @brief A definition of an option for the bulk registration.
+   * @note `nargs` and `comment` are zero and empty if omitted in an
+   * aggregate initialization.
+   */
+  struct option_spec {
+    args dirs;         /**< The directive strings of the option */
+    arg name;          /**< The name of the option */
+    value_type type;   /**< The type of elements */
+    int16_t nargs;     /**< The number of elements */
+    arg comment;       /**< The description of the option */
+  };
+
+  /**
+   * @brief A definition of a positional argument for the bulk registration.
+   */
+  struct argument_spec {
+    arg name;          /**< The name of the argument */
+    value_type type;   /**< The type of elements */
+    int16_t nargs;     /**< The number of elements */
+    arg comment;       /**< The description of the argument */
+  };
+
+  /**
+   * @brief The usage of an argument counted by the telemetry.
+   */
+  struct usage_counter {
+    arg name;          /**< The name of the argument */
+    uint64_t given;    /**< The number of the occurrences in the inputs */
+    uint64_t read;     /**< The number of the reads by the accessors */
+  };
+
+  /**
+   * @brief The budgets for parsing an untrusted command line.
+   *
+   * Every budget is unlimited by default. A command line which exceeds a
+   * budget is an error.
+   */
+  struct parse_limits {
+    size_t max_tokens;       /**< The number of the expanded elements */
+    size_t max_token_bytes;  /**< The length of an element */
+    size_t max_value_bytes;  /**< The total length of the stored values */
+    size_t max_depth;        /**< The nesting depth of the response files */
+    size_t max_values;       /**< The number of the values of an argument */
+    size_t max_response_bytes; /**< The total size of the response files */
+    parse_limits(void)
+      : max_tokens(std::numeric_limits<size_t>::max()),
+        max_token_bytes(std::numeric_limits<size_t>::max()),
+        max_value_bytes(std::numeric_limits<size_t>::max()),
+        max_depth(std::numeric_limits<size_t>::max()),
+        max_values(std::numeric_limits<size_t>::max()),
+        max_response_bytes(std::numeric_limits<size_t>::max())
+    { }
+  };
+
+  class layered_config;
+
   /**
    * @brief An argument parser class
    */
@@ -645,17 +1110,30 @@ namespace argparse {
      * @param[in] nargs `nargs` given in the main function.
      * @param[in] argv `argv` given in the main function.
      * @param[in] desc The description of the main program.
+     *
+     * @note The elements in `argv` are referred to without any copy, so
+     * that `argv` should be alive until the parser is destroyed.
      */
     argparse(const int nargs, const char** argv,
              arg desc="", bool with_help=true)
-      : _description(desc),_completed(false),_varargs(false),_appname(argv[0])
+      : _description(desc),_completed(false),_varargs(false),
+        _known_args(false),_interpolation(false),_response_files(false),
+        _tokenized(false),_prescanned(false),
+        _appname(argv[0]),_argv0(argv[0]),
+        _arguments{argv+1, argv+((nargs>1)?nargs:1)},_cursor(0),
+        _fingerprint(0),_fingerprinted(false),_ncounters(0),_exit_at(npos),
+        _value_bytes(0)
     {
-      for (int i=1; i<nargs; i++)
-        _arguments.push_back(arg(argv[i]));
-      if (with_help)
-        _optional_parsers.push_back
+      _passthrough.push_back(_argv0);
+      _passthrough.push_back(nullptr);
+      compile_index();
+      if (with_help) {
+        register_option
           (optional_argument((args){"-h","--help"}, "help",
                              value_type::Bool, 0, "Show a help message"));
+        _slots[_option_slots.back()].exits = true;
+        _opt_exit.back() = 1;
+      }
     }
     /**
      * @brief Create an argument parser instance.
@@ -664,7 +1142,7 @@ namespace argparse {
      * @param[in] desc The description of the main program.
      */
     argparse(int nargs, char** argv, arg desc="")
-      : argparse((const int)nargs, (const char**)argv, desc)
+      : argparse(nargs, (const char**)argv, desc)
     { }
 
     /**
@@ -673,12 +1151,273 @@ namespace argparse {
     void parse(const bool help_on_error = true,
                const bool show_help_and_exit = true);
 
+    /**
+     * @brief Parse new input arguments with the registered arguments.
+     * @param[in] nargs The number of the elements in `argv`.
+     * @param[in] argv The elements of a command line.
+     *
+     * @note The previous values are cleared by `reset()`, but the buffers
+     * of the parser are reused. The elements in `argv` are referred to by
+     * the parser, so that `argv` should be alive until the next `parse`.
+     */
+    void parse(const int nargs, const char** argv,
+               const bool help_on_error = true,
+               const bool show_help_and_exit = true);
+    /**
+     * @brief Parse new input arguments with the registered arguments.
+     * @param[in] nargs The number of the elements in `argv`.
+     * @param[in] argv The elements of a command line.
+     */
+    void parse(int nargs, char** argv,
+               const bool help_on_error = true,
+               const bool show_help_and_exit = true)
+    { parse(nargs, (const char**)argv,
+            help_on_error, show_help_and_exit); }
+
+    /**
+     * @brief Clear the parsed values and keep the registered arguments.
+     *
+     * @note The capacity of every buffer is retained, so that a parser
+     * reused in a loop does not reallocate memory in the steady state.
+     */
+    void reset(void);
+
+    /**
+     * @brief Scan the input arguments only for the given options.
+     * @param[in] names The names of the options to be scanned.
+     * @exception std::runtime_error is thrown if a name is not an option
+     * or if the conversion of a value is failed.
+     *
+     * @note This function is designed for the options which are required
+     * before the other arguments are registered, e.g., a configuration
+     * file or a log level. The other elements are neither converted nor
+     * validated, and the values are available via `get()` until `parse()`
+     * is called. The expanded arguments are reused by `parse()`. The
+     * references in the values are substituted with the scanned options
+     * or the environment variables.
+     */
+    void prescan(const args& names);
+
+    /**
+     * @brief Continue parsing with the arguments registered afterwards.
+     *
+     * @note This function continues from the last `parse()`, `prescan()`
+     * or `resume()`. The elements claimed by the options are kept with
+     * their values, and only the unclaimed elements are matched against
+     * the options. Then, the positional arguments are assigned again from
+     * the unclaimed elements. The expanded arguments are reused. A value
+     * of a new option never takes an element which is already claimed.
+     */
+    void resume(const bool help_on_error = true,
+                const bool show_help_and_exit = true);
+
     /**
      * @brief Show the current status of the parser.
      * @param[in] output A file descriptor for output. [default: `stdout`]
      */
     void display_status(FILE* output=stdout) const;
 
+    /**
+     * @brief Regenerate a canonical command line from the parsed values.
+     * @param[out] out The buffer which stores the command line.
+     * @param[in] names The names of the arguments to be emitted. All the
+     * parsed arguments are emitted if empty.
+     * @exception std::runtime_error is thrown if not parsed.
+     *
+     * @exception std::runtime_error is thrown if a positional anchor
+     * follows a scoped option with a variable number of values.
+     *
+     * @note The first directive is used for each option. The elements are
+     * ordered as the `format()` function does, so that the command line is
+     * parsed into the same values. The help option is never emitted. The
+     * anchors and the scoped options are emitted for each occurrence in
+     * the original order, at the position of the positional anchor if any
+     * or at the end otherwise.
+     */
+    void serialize(argv_buffer& out, const args& names = args()) const;
+
+    /**
+     * @brief Store the parsed values in a self-describing binary layout.
+     * @param[out] out The buffer which stores the snapshot.
+     * @exception std::runtime_error is thrown if not parsed, or if an
+     * anchor or a scoped option is given, since the occurrences are not
+     * stored.
+     *
+     * @note The snapshot consists of a `snapshot_header`, an array of
+     * `snapshot_entry`'s sorted by the names, an array of the offsets of
+     * the values, and NUL-terminated strings. All the offsets are counted
+     * from the beginning of the snapshot. The snapshot is available via
+     * argparse::snapshot_view.
+     */
+    void snapshot(std::vector<char>& out) const;
+
+#ifdef __linux__
+    /**
+     * @brief Publish the parsed values in a sealed shared memory.
+     * @return A file descriptor of the shared memory.
+     * @exception std::runtime_error is thrown if failed.
+     *
+     * @note The snapshot is written into a `memfd` which is sealed against
+     * any modification. The file descriptor is inherited by the children
+     * and by `exec`'d processes, which attach the snapshot with
+     * argparse::snapshot_view::attach().
+     */
+    int publish(void) const;
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+    /**
+     * @brief Append a record of the parsed values to a log.
+     * @param[in] fd A file descriptor of the log opened with `O_APPEND`.
+     * @param[in] status The exit status of the invocation.
+     * @exception std::runtime_error is thrown if not parsed or if failed.
+     *
+     * @note A record consists of a `record_header` and a snapshot of the
+     * values. The header holds the fingerprint of the arguments, the time,
+     * the process ID and the status. The snapshot is built in a buffer
+     * reused by the parser, and the record is written by a single
+     * `writev`, so that records of concurrent processes are not mixed.
+     * Each record is padded to a multiple of 8 bytes, so that the next
+     * record is aligned in the log.
+     */
+    void record(const int fd, const int status = 0);
+    /**
+     * @brief Append a record of the parsed values to a log file.
+     * @param[in] path The path to the log file, created if missing.
+     * @param[in] status The exit status of the invocation.
+     * @exception std::runtime_error is thrown if not parsed or if failed.
+     */
+    void record(const arg& path, const int status = 0);
+#endif
+
+    /**
+     * @brief Restore the parsed values from a record.
+     * @param[in] data The beginning of a record in a log.
+     * @param[in] size The number of the bytes available from `data`.
+     * @return The size of the record, i.e., the offset of the next one.
+     * @exception std::runtime_error is thrown if the record is broken, if
+     * it is not aligned to 8 bytes, or if it is made with different
+     * arguments.
+     *
+     * @note The values are stored as if they were parsed, and available
+     * via `get()`. The elements of the original command line are not
+     * restored. The header is available by casting `data` to
+     * argparse::record_header.
+     */
+    size_t replay(const void* data, const size_t size);
+
+    /**
+     * @brief Enable or disable the usage counters of the arguments.
+     * @param[in] enable The counters are enabled if true.
+     *
+     * @note When enabled, each argument counts how often it is given in
+     * the inputs and how often it is read by `get()`, `getall()` and
+     * `find()`. The counters are relaxed atomics, so that the accessors
+     * may be called from several threads. The counters are kept across
+     * `parse()` and cleared when disabled. They are reallocated when
+     * arguments are added, so that the accessors should not be called
+     * during the registration or `parse()`. A copy of the parser starts
+     * with a copy of the current counters.
+     */
+    void set_telemetry(const bool enable);
+
+    /**
+     * @brief Obtain the current values of the usage counters.
+     * @return The counters of the arguments sorted by the names, or an
+     * empty array if the counters are disabled.
+     */
+    std::vector<usage_counter> usage(void) const;
+
+    /**
+     * @brief Append the usage counters to a file.
+     * @param[in] path The path to the file, created if missing.
+     * @exception std::runtime_error is thrown if failed.
+     *
+     * @note A line of the application, the name, and the counters of the
+     * occurrences and the reads, separated by tabs, is written for each
+     * argument. The lines are written at once, e.g., by a function
+     * registered with `atexit()`.
+     */
+    void save_usage(const arg& path) const;
+
+    /**
+     * @brief Write the registered arguments to a cache file.
+     * @param[in] path The path to the cache file.
+     * @param[in] key A text which identifies the definitions, e.g., the
+     * version of the application or the source of a schema.
+     * @exception std::runtime_error is thrown if failed.
+     *
+     * @note The options, the positional arguments, the presets and the
+     * description are stored. The plugins are not stored. The file is
+     * replaced atomically, so that concurrent processes never read a
+     * partially written cache. The hash stored in the file is derived
+     * from `fingerprint()` and `key`.
+     */
+    void save_spec(const arg& path, const arg& key) const;
+
+    /**
+     * @brief Replace the registered arguments with a cache file.
+     * @param[in] path The path to the cache file.
+     * @param[in] key The text given to `save_spec()`.
+     * @return True if loaded. False if the cache is missing, broken,
+     * modified, or created with a different key, and nothing is changed.
+     *
+     * @note The cache file is mapped into memory and the fingerprint of
+     * the contents is checked against the stored hash. The names and the
+     * directives are stored in sorted order with their slots, so that the
+     * maps are rebuilt by appending without any search or check of the
+     * registration. A typical usage is to register the arguments and
+     * call `save_spec()` only when `load_spec()` returns false.
+     */
+    bool load_spec(const arg& path, const arg& key);
+
+    /**
+     * @brief Register the arguments defined in a JSON schema.
+     * @param[in] input A stream of the schema.
+     * @exception std::runtime_error is thrown if the schema is malformed
+     * or if an argument is not acceptable.
+     *
+     * @note The schema is an object with `description`, `options`,
+     * `arguments` and `presets`. An option has `directives`, `name`,
+     * `type` (`bool`, `integer`, `float` or `string`), `nargs`, `comment`,
+     * `default`, `choices`, `anchor` and `scope`. A positional argument
+     * has the same members except for `directives`, `anchor` and `scope`.
+     * A preset has `directive`, `elements` and `comment`. The storage is
+     * reserved for all the arguments before the registration.
+     */
+    void load_schema(std::istream& input);
+
+    /**
+     * @brief Write the registered arguments as a JSON schema.
+     * @param[out] output A stream of the schema.
+     * @note The predefined help option and the plugins are not written.
+     */
+    void dump_schema(std::ostream& output) const;
+
+    /**
+     * @brief Generate a C++ source of a parser for the registered arguments.
+     * @param[out] output A stream of the source.
+     * @param[in] ns The namespace of the generated parser.
+     * @exception std::runtime_error is thrown if a feature is not supported.
+     *
+     * @note The generated source defines `result`, `parse()` and
+     * `show_help()` in the namespace. The directives are matched by their
+     * lengths and bytes without any map, the values are stored in typed
+     * members of `result`, and the help message is a static text. The
+     * values and the errors are the same as `parse()` without the help
+     * handling. An option to stop parsing, e.g., `--help`, is stored in
+     * `exit_option` and the rest is skipped. The parse-known-args mode,
+     * response files, presets, scoped options, interpolation and plugins
+     * are not supported.
+     */
+    void generate(std::ostream& output, const arg& ns) const;
+
+    /**
+     * @brief Calculate a fingerprint of the registered arguments.
+     * @return The FNV-1a hash of the compiled definitions.
+     */
+    uint64_t fingerprint(void) const;
+
     /**
      * @brief List the formats of the registered arguments.
      * @param[in] output A file descriptor for output. [default: `stdout`]
@@ -703,7 +1442,97 @@ namespace argparse {
      * @param[in] desc The description of the program.
      */
     void set_description(const arg& desc)
-    { _description = desc; }
+    { _description = desc; _fingerprinted = false; }
+
+    /**
+     * @brief Enable or disable the interpolation of values.
+     * @param[in] flag References in values are substituted if true.
+     *
+     * @note A reference `${name}` in a value is replaced by the first value
+     * of the argument `name`, or by the environment variable `name` if the
+     * argument is not given. The references are resolved once after
+     * parsing in the order of the dependencies, and the results are stored
+     * as the values. Circular or undefined references are errors. The
+     * values are validated after the substitution.
+     */
+    void set_interpolation(const bool flag)
+    { _interpolation = flag; }
+
+    /**
+     * @brief Enable or disable the parse-known-args mode.
+     * @param[in] flag Unknown options are passed through if true.
+     *
+     * @note In the parse-known-args mode, an element which looks like an
+     * option but matches no directive is not used as a positional argument.
+     * The element is stored in the passthrough list instead. The following
+     * elements are passed through with it only if declared by
+     * `add_passthrough()`, e.g., `--opt=value` is passed as it is but
+     * `--opt value` leaves `value` to the positional arguments.
+     */
+    void set_known_args(const bool flag)
+    { _known_args = flag; }
+
+    /**
+     * @brief Declare the number of the values of an unknown option.
+     * @param[in] dir The directive of an option of the child process.
+     * @param[in] n The number of the elements passed through with it.
+     * @exception std::runtime_error is thrown if `n` is negative or if the
+     * directive is defined.
+     */
+    void add_passthrough(const arg& dir, const int16_t n);
+
+    /**
+     * @brief Enable or disable the expansion of response files.
+     * @param[in] flag An element `@path` is replaced by the file if true.
+     *
+     * @note A response file contains elements separated by white spaces.
+     * An element may be quoted by `"` or `'`. A response file may refer to
+     * other response files. The files are loaded concurrently by up to
+     * eight tasks, and a nested file starts loading as soon as a task is
+     * available. The elements are
+     * spliced in the order of the command line, and a circular reference
+     * is an error. Programs should be linked with `-pthread` on old systems.
+     */
+    void set_response_files(const bool flag)
+    { _response_files = flag; _tokenized = false; }
+
+    /**
+     * @brief Set the budgets for parsing the input arguments.
+     * @param[in] limits The budgets of the resources.
+     *
+     * @note The number and the length of the elements are checked while
+     * the elements are expanded. Every element of the command line counts
+     * as an element, even if it refers to an empty response file. The
+     * response files share a budget of bytes, which is derived from the
+     * number and the length of the elements unless it is given, and a
+     * file over the budget is not read to the end. The values are checked
+     * when they are stored. A command line over a budget fails before
+     * the storage for it is allocated.
+     */
+    void set_limits(const parse_limits& limits)
+    { _limits = limits; _tokenized = false; }
+
+    /**
+     * @brief Return the elements passed through in the parse-known-args mode.
+     * @return A null-terminated array of pointers into `argv`.
+     * @note The first element is the name of the application, so that the
+     * array is available as `argv` of a child process as it is.
+     */
+    const std::vector<const char*>& passthrough(void) const
+    { return _passthrough; }
+
+    /**
+     * @brief Find the directives similar to a given element.
+     * @param[in] s An element which is possibly a misspelled directive.
+     * @param[in] max The maximum number of the suggestions.
+     * @return The directives sorted by the edit distance.
+     *
+     * @note The Levenshtein distances are calculated by the bit-parallel
+     * algorithm of Myers. The directives whose lengths differ too much are
+     * skipped without any calculation. An element longer than 64 characters
+     * has no suggestion.
+     */
+    args suggest(const arg& s, const size_t max = 3) const;
 
     /**
      * @brief Obtain all the values associated with the given name.
@@ -751,8 +1580,8 @@ namespace argparse {
      * @brief Check an optional argument is defined or not.
      * @param[in] name The name of the argument in question.
      */
-    const bool find(const arg& name) const
-    { return (_map.find(name) != _map.end()); }
+    bool find(const arg& name) const
+    { return (read(name) != nullptr); }
 
     /**
      * @brief Add a positional argument with an element without a comment.
@@ -786,7 +1615,9 @@ namespace argparse {
         throw std::runtime_error("cannot add any argument after varargs.");
       if (n<0) _varargs = true;
       _positional_parsers.push_back(positional_argument(name, type, n, com));
+      _positional_slots.push_back(allocate_slot(name, type));
       _completed = false;
+      _fingerprinted = false;
     }
 
     /**
@@ -844,8 +1675,7 @@ namespace argparse {
                     const int16_t n, const arg& com="") {
       if (name == "help")
         throw std::runtime_error("the name \"help\" is predefined.");
-      _optional_parsers.push_back(optional_argument(dir, name, type, n, com));
-      _completed = false;
+      register_option(optional_argument(dir, name, type, n, com));
     }
     /**
      * @brief Add an optional argument with elements.
@@ -860,262 +1690,4484 @@ namespace argparse {
                     const int16_t n, const arg& com="") {
       if (name == "help")
         throw std::runtime_error("the name \"help\" is predefined.");
-      _optional_parsers.push_back(optional_argument(dirs, name, type, n, com));
-      _completed = false;
+      register_option(optional_argument(dirs, name, type, n, com));
     }
-  private:
-    arg _description;             /**< The description of the application */
-    bool _completed;              /**< True if `parse` is successfully done */
-    bool _varargs;                /**< True if vararg is defined */
-    int32_t _nargs;               /**< The number of arguments */
-    std::string _appname;         /**< The name of the application */
-    std::map<arg, values> _map;   /**< The map of (name, values) */
-    std::vector<arg> _arguments;  /**< The array of arguments */
+
+    /**
+     * @brief Add optional arguments at once.
+     * @param[in] specs The definitions of the options.
+     * @exception std::runtime_error is thrown if a directive is defined,
+     * if a name is duplicated or already registered, if a name is "help",
+     * or if a non-boolean option takes no element. Nothing is registered
+     * in that case.
+     *
+     * @note The definitions are checked with hash sets in linear time.
+     * The storage and the hash table of the directives are grown once for
+     * all the options, which are appended to the tables in a single pass.
+     * The names are sorted and merged into the map of the names at last.
+     */
+    void add_options(const std::vector<option_spec>& specs);
+
+    /**
+     * @brief Add positional arguments at once.
+     * @param[in] specs The definitions of the arguments.
+     * @exception std::runtime_error is thrown if a name is duplicated or
+     * already registered, if a name is "help", if a non-boolean argument
+     * takes no element, or if an argument follows varargs. Nothing is
+     * registered in that case.
+     */
+    void add_arguments(const std::vector<argument_spec>& specs);
+
+    /**
+     * @brief Set the default values of an argument.
+     * @param[in] name The name of the argument.
+     * @param[in] vals The values used when the argument is not given.
+     * @exception std::runtime_error is thrown if the name is not found or
+     * if a value is not convertible.
+     */
+    void set_default(const arg& name, const args& vals);
+
+    /**
+     * @brief Restrict the values of an argument.
+     * @param[in] name The name of the argument.
+     * @param[in] vals The acceptable values.
+     * @exception std::runtime_error is thrown if the name is not found.
+     * @note The values are checked after the interpolation.
+     */
+    void set_choices(const arg& name, const args& vals);
+
+    /**
+     * @brief Add a preset which expands into a sequence of elements.
+     * @param[in] dir The directive string of the preset.
+     * @param[in] elements The elements which replace the directive.
+     * @param[in] com The description of the preset.
+     * @exception std::runtime_error is thrown if the directive is defined,
+     * if the presets refer to each other recursively, or if the command
+     * line has already been parsed.
+     *
+     * @note A preset may contain the directives of other presets. They are
+     * expanded at the registration, so that each preset is stored as a
+     * flat sequence of elements and spliced without re-tokenizing.
+     */
+    void add_preset(const arg& dir, const args& elements,
+                    const arg& com="");
+
+    /**
+     * @brief Add an option whose values belong to an occurrence of another.
+     * @param[in] dir The directive string of the option.
+     * @param[in] name The name of the option.
+     * @param[in] type The type of elements.
+     * @param[in] n The number of elements.
+     * @param[in] anchor The name of the registered argument to bind to.
+     * @param[in] scope The occurrence of the anchor to bind to.
+     * @param[in] com The description of the option.
+     * @exception std::runtime_error is thrown if the anchor is not defined
+     * or if the name is already registered.
+     *
+     * @note Each value of a positional anchor and each occurrence of an
+     * optional anchor makes an occurrence. For example, with `-r` bound to
+     * `-i`, `-r 30 -i a.mp4 -r 60 -i b.mp4` gives two occurrences of `-i`
+     * with `-r` of 30 and 60. A scoped option which is bound to nothing
+     * is an error. The first occurrence is also available via `get()`.
+     */
+    void add_scoped_option(const arg& dir, const arg& name,
+                           const value_type type, const int16_t n,
+                           const arg& anchor,
+                           const scope_type scope = scope_type::Next,
+                           const arg& com="") {
+      add_scoped_option(args{dir}, name, type, n, anchor, scope, com);
+    }
+    /**
+     * @brief Add an option whose values belong to an occurrence of another.
+     * @param[in] dirs The directive strings of the option.
+     * @param[in] name The name of the option.
+     * @param[in] type The type of elements.
+     * @param[in] n The number of elements.
+     * @param[in] anchor The name of the registered argument to bind to.
+     * @param[in] scope The occurrence of the anchor to bind to.
+     * @param[in] com The description of the option.
+     * @exception std::runtime_error is thrown if the anchor is not defined
+     * or if the name is already registered.
+     */
+    void add_scoped_option(const std::vector<arg>& dirs, const arg& name,
+                           const value_type type, const int16_t n,
+                           const arg& anchor,
+                           const scope_type scope = scope_type::Next,
+                           const arg& com="");
+
+    /**
+     * @brief Return the number of the occurrences of an anchor.
+     * @param[in] anchor The name of an argument used as an anchor.
+     * @return The number of the occurrences.
+     */
+    size_t occurrences(const arg& anchor) const;
+
+    /**
+     * @brief Add a switch which stops parsing when it is given.
+     * @param[in] dirs The directive strings of the switch.
+     * @param[in] name The name of the switch.
+     * @param[in] com The description of the switch.
+     *
+     * @note When the switch appears, the following elements are neither
+     * matched nor converted, and the positional arguments, the defaults
+     * and the choices are not processed. The options given before the
+     * switch are available. The predefined help option is such a switch.
+     * The name of the switch is returned by `exit_option()`.
+     */
+    void add_exit_option(const args& dirs, const arg& name,
+                         const arg& com="");
+
+    /**
+     * @brief Return the name of the switch which stopped parsing.
+     * @return The name of the switch, or an empty string if none.
+     */
+    const arg& exit_option(void) const { return _exit; }
+
+#if defined(__unix__) || defined(__APPLE__)
+    /** A function exported by a plugin to register its arguments */
+    typedef void (*plugin_function)(argparse&);
+
+    /**
+     * @brief Register a plugin which is loaded only when required.
+     * @param[in] path The path to the shared object of the plugin.
+     * @param[in] dirs The directives defined by the plugin.
+     * @param[in] symbol The name of the `plugin_function` of the plugin.
+     * @exception std::runtime_error is thrown if a directive is defined.
+     *
+     * @note The plugin is loaded by `dlopen()` when one of the directives
+     * appears in the input arguments or when the help option is given.
+     * Then, the `plugin_function` is called to register the arguments.
+     * The function should be declared with `extern "C"`.
+     */
+    void add_plugin(const arg& path, const args& dirs,
+                    const arg& symbol="argparse_plugin_init");
+
+    /**
+     * @brief Load all the registered plugins.
+     * @exception std::runtime_error is thrown if a plugin is not loaded.
+     */
+    void load_plugins(void);
+#endif
+
+    /**
+     * @brief Obtain the values associated with an occurrence of an anchor.
+     * @param[in] name The name of the anchor or a scoped option.
+     * @param[in] k The index of the occurrence of the anchor.
+     * @return An array of the values.
+     * @exception std::runtime_error is thrown when no value is found.
+     */
+    template <class T>
+    const std::vector<T> getall_scoped(const arg& name, const size_t k) const;
+
+    /**
+     * @brief Obtain the first value associated with an occurrence.
+     * @param[in] name The name of the anchor or a scoped option.
+     * @param[in] k The index of the occurrence of the anchor.
+     * @return The first value.
+     * @exception std::runtime_error is thrown when no value is found.
+     */
+    template <class T>
+    const T get_scoped(const arg& name, const size_t k) const;
+
+    /**
+     * @brief Obtain the first value associated with an occurrence.
+     * @param[in] name The name of the anchor or a scoped option.
+     * @param[in] k The index of the occurrence of the anchor.
+     * @param[in] dummy A dummy value returned if no value is found.
+     * @return The first value.
+     */
+    template <class T>
+    const T get_scoped(const arg& name, const size_t k, const T& dummy) const;
+  private:
+    friend class layered_config;
+    /**
+     * A container which is empty in a copy of the parser, since it refers
+     * to the storage of the original parser.
+     */
+    template <class T>
+    struct transient : public T {
+      transient(void) : T() { }
+      transient(const transient&) : T() { }
+      transient& operator=(const transient&) { T::clear(); return *this; }
+    };
+    /** A flag which is cleared in a copy of the parser */
+    struct transient_flag {
+      bool value;       /**< The value of the flag */
+      transient_flag(const bool v) : value(v) { }
+      transient_flag(const transient_flag&) : value(false) { }
+      transient_flag& operator=(const transient_flag&)
+      { value = false; return *this; }
+      transient_flag& operator=(const bool v) { value = v; return *this; }
+      operator bool(void) const { return value; }
+    };
+
+    arg _description;             /**< The description of the application */
+    bool _completed;              /**< True if `parse` is successfully done */
+    bool _varargs;                /**< True if vararg is defined */
+    bool _known_args;             /**< True if unknown options pass through */
+    bool _interpolation;          /**< True if references are substituted */
+    bool _response_files;         /**< True if response files are expanded */
+    transient_flag _tokenized;    /**< True if `_tokens` is up to date */
+    bool _prescanned;             /**< True if `prescan` is done */
+    int32_t _nargs;               /**< The number of arguments */
+    std::string _appname;         /**< The name of the application */
+    const char* _argv0;           /**< The name in `argv`, for passthrough */
+    std::map<arg, int16_t> _passthrough_nargs; /**< The declared values */
+    /** A range of the elements in `argv`, which are not copied */
+    struct element_range {
+      const char** first;   /**< The first element */
+      const char** last;    /**< The end of the elements */
+      const char** begin(void) const { return first; }
+      const char** end(void) const { return last; }
+      size_t size(void) const { return last-first; }
+    };
+    element_range _arguments;     /**< The array of arguments */
+    size_t _cursor;               /**< The next argument to be expanded */
+    /** The expanded arguments, which are expanded again in a copy */
+    transient<std::vector<const char*>> _tokens;
+    transient<std::vector<uint8_t>> _claimed; /**< Non-zero if claimed */
+    std::vector<const char*> _remaining;   /**< The unclaimed arguments */
+    std::vector<const char*> _passthrough; /**< The passed-through elements */
     std::vector<positional_argument> _positional_parsers;
     std::vector<optional_argument>   _optional_parsers;
+    arg _key;                     /**< A buffer to look up the directives */
+
+    /**
+     * The tables used to match the elements. The directives and the names
+     * are stored in a string table. The directives are found through an
+     * open-addressing hash table of their FNV-1a hashes. The tables are
+     * the only index of the directives, and are extended at every
+     * registration.
+     */
+    std::vector<char> _strings;          /**< The NUL-terminated strings */
+    std::vector<uint32_t> _dir_table;    /**< The buckets (directive + 1) */
+    std::vector<uint64_t> _dir_hash;     /**< The hashes of the directives */
+    std::vector<uint32_t> _dir_length;   /**< The lengths of the directives */
+    std::vector<uint32_t> _dir_offset;   /**< The directives in `_strings` */
+    std::vector<uint32_t> _dir_option;   /**< The options of the directives */
+    std::vector<int16_t> _opt_nargs;     /**< The numbers of the elements */
+    std::vector<value_type> _opt_type;   /**< The types of the elements */
+    std::vector<uint32_t> _opt_name;     /**< The names in `_strings` */
+    std::vector<uint8_t> _opt_exit;      /**< Non-zero if parsing stops */
+    std::vector<char> _record;    /**< The buffer of the recorded snapshot */
+    mutable uint64_t _fingerprint; /**< The fingerprint, if up to date */
+    mutable bool _fingerprinted;  /**< True if `_fingerprint` is up to date */
+    /** An array of atomic counters, copied as a snapshot of the counts */
+    class counter_array {
+    public:
+      counter_array(void) : _size(0) { }
+      explicit counter_array(const size_t n)
+        : _data(new std::atomic<uint64_t>[n]),_size(n)
+      {
+        for (size_t i=0; i<n; i++)
+          _data[i].store(0, std::memory_order_relaxed);
+      }
+      counter_array(const counter_array& c) : counter_array(c._size)
+      {
+        for (size_t i=0; i<_size; i++)
+          _data[i].store(c._data[i].load(std::memory_order_relaxed),
+                         std::memory_order_relaxed);
+      }
+      counter_array& operator=(const counter_array& c)
+      { counter_array copy(c); swap(copy); return *this; }
+      void swap(counter_array& c)
+      { _data.swap(c._data); std::swap(_size, c._size); }
+      void reset(void) { _data.reset(); _size = 0; }
+      explicit operator bool(void) const { return (bool)_data; }
+      std::atomic<uint64_t>& operator[](const size_t i) const
+      { return _data[i]; }
+    private:
+      std::unique_ptr<std::atomic<uint64_t>[]> _data; /**< The counters */
+      size_t _size;             /**< The number of the counters */
+    };
+    /** The usage counters, (given, read) for each slot, if enabled */
+    counter_array _counters;
+    size_t _ncounters;            /**< The number of the counted slots */
+    std::vector<size_t> _scanned; /**< The slots counted by `prescan` */
+    arg _exit;                    /**< The name of the switch given to stop */
+    size_t _exit_at;              /**< The element of the switch, if given */
+
+    /** The storage of the values associated with a name */
+    struct slot {
+      value_type type;  /**< The type of the values */
+      values v;         /**< The buffer of the values */
+      size_t n;         /**< The number of the stored values */
+      bool found;       /**< True if the argument is given */
+      int8_t role;      /**< 1 if an anchor, 2 if scoped, otherwise 0 */
+      bool exits;       /**< True if parsing stops at the argument */
+      scope_type scope; /**< The direction to the anchor if scoped */
+      size_t anchor;    /**< The slot of the anchor if scoped */
+      size_t first_group; /**< The first group in `_group_order` */
+      size_t ngroups;   /**< The number of the groups if an anchor */
+      size_t cursor;    /**< A working variable for the binding */
+      args defaults;    /**< The values used if not given */
+      args choices;     /**< The acceptable values, if any */
+    };
+    std::map<arg, size_t> _names;          /**< The map of (name, slot) */
+    std::vector<slot> _slots;              /**< The array of the slots */
+    std::vector<size_t> _option_slots;     /**< The slots of the options */
+    std::vector<size_t> _positional_slots; /**< The slots of the arguments */
+    std::vector<size_t> _remaining_index;  /**< The positions of `_remaining` */
+
+    /** An occurrence of an anchor or a scoped option */
+    struct event {
+      size_t slot;      /**< The slot of the argument */
+      size_t position;  /**< The position in the expanded arguments */
+      size_t first;     /**< The first element in `_scoped_elements` */
+      size_t count;     /**< The number of the elements */
+    };
+    /** An occurrence of an anchor with the scoped options bound to it */
+    struct group {
+      size_t event;     /**< The event of the anchor */
+      size_t begin;     /**< The first binding in `_bindings` */
+      size_t end;       /**< The end of the bindings in `_bindings` */
+    };
+    std::vector<event> _events;             /**< The recorded occurrences */
+    std::vector<const char*> _scoped_elements; /**< The scoped elements */
+    std::vector<group> _groups;             /**< The groups by position */
+    std::vector<size_t> _group_order;       /**< The groups by anchor */
+    std::vector<size_t> _bindings;          /**< The events by group */
+    std::vector<size_t> _event_group;       /**< The group of each event */
+
+    /** A sequence of elements associated with a directive */
+    struct preset {
+      arg directive;    /**< The directive of the preset */
+      arg comment;      /**< The description of the preset */
+      args elements;    /**< The flattened elements */
+    };
+    std::map<arg, size_t> _preset_index; /**< The map of (directive, preset) */
+    std::vector<preset> _presets;        /**< The array of the presets */
+
+#if defined(__unix__) || defined(__APPLE__)
+    /** A shared object which registers arguments */
+    struct plugin {
+      arg path;         /**< The path to the shared object */
+      arg symbol;       /**< The name of the `plugin_function` */
+      void* handle;     /**< The handle given by `dlopen`, if loaded */
+    };
+    std::map<arg, size_t> _plugin_index; /**< The map of (directive, plugin) */
+    std::vector<plugin> _plugins;        /**< The array of the plugins */
+
+    /** Load a plugin and register its arguments */
+    void load_plugin(const size_t i);
+    /** Load the plugins whose directives are given from an element */
+    void load_requested_plugins(const size_t first);
+#endif
+
+    /** Expand the presets in the input arguments */
+    void tokenize(void);
+    /** Expand the next chunk of the input arguments */
+    void expand(void);
+    /** Expand the input arguments until an element is available */
+    bool available(std::vector<const char*>::const_iterator& vp);
+
+    /** The elements of a response file */
+    struct response {
+      std::vector<char> text;             /**< The NUL-terminated elements */
+      std::vector<const char*> elements;  /**< The elements in `text` */
+      response(void) { }
+      /** The elements of a copy refer to the copied text. */
+      response(const response& r) : text(r.text)
+      {
+        elements.reserve(r.elements.size());
+        for (auto e : r.elements)
+          elements.push_back(text.data()+(e-r.text.data()));
+      }
+      response(response&&) = default;
+      response& operator=(const response& r)
+      { response copy(r); return (*this = std::move(copy)); }
+      response& operator=(response&&) = default;
+    };
+    std::map<arg, response> _responses;   /**< The map of (path, file) */
+    /** Load the response files referred to by the input arguments */
+    void load_responses(void);
+    /** Read a response file and split it into elements */
+    static response read_response(const arg& path,
+                                  std::atomic<size_t>& budget);
+
+    parse_limits _limits;         /**< The budgets of the resources */
+    size_t _value_bytes;          /**< The total length of the values */
+    /** Check the length of an element against the budget */
+    void check_token(const char* s) const;
+    /** Check if a directive is taken by an option, preset or plugin */
+    bool is_defined(const arg& dir) const;
+    /** Register an optional argument with its directives */
+    void register_option(optional_argument&& o, const bool checked=false);
+    /** Build the tables used to match the elements */
+    void compile_index(void);
+    /** Append an option to the tables used to match the elements */
+    void index_option(const size_t i);
+    /** Put a directive into the buckets of the hash table */
+    void bucket(const size_t j);
+    /** Rebuild the hash table with a given number of the buckets */
+    void rehash(const size_t nbuckets);
+    /** Insert the names of new slots into `_names` as a sorted batch */
+    void merge_names(std::vector<std::pair<const arg*, size_t>>& batch);
+    /** Append a string to `_strings` and return its offset */
+    uint32_t intern(const arg& str);
+    /** Find the option associated with an element, or `npos` if none */
+    size_t find_directive(const char* s) const
+    { return find_directive(s, std::strlen(s)); }
+    /** Find the option associated with `n` bytes, or `npos` if none */
+    size_t find_directive(const char* s, const size_t n) const;
+    /** The index returned by `find_directive` if not found */
+    static const size_t npos = (size_t)-1;
+    /** Obtain the slot associated with a name, or create a new one */
+    size_t allocate_slot(const arg& name, const value_type type);
+    /** Obtain the slot of a given argument, or `nullptr` if not given */
+    const slot* lookup(const arg& name) const;
+    /** Count a read of an argument and obtain its slot if given */
+    const slot* read(const arg& name) const;
+    /** Count an occurrence of an argument in the inputs */
+    void count(const size_t k) {
+      if (k < _ncounters)
+        _counters[2*k].fetch_add(1, std::memory_order_relaxed);
+    }
+    /** Allocate the usage counters for all the slots */
+    void grow_counters(void);
+    /** Append an element to a slot */
+    void store(const size_t i, const char* s);
+    /** Check whether an element is convertible to a type */
+    void validate(const value_type type, const char* s) const;
+
+    std::vector<size_t> _pending;   /**< The slots with references */
+    std::vector<uint8_t> _visit;    /**< The states of the resolution */
+    /** Substitute the references in the values */
+    void interpolate(void);
+    /** Substitute the references in the values of a slot */
+    void resolve(const size_t k);
+    /** Clear the results except for the claimed options */
+    void rewind(void);
+    /** Process the unclaimed elements and store values */
+    void process(const bool help_on_error, const bool show_help_and_exit);
+    /** Process an option and its values from the next element */
+    void consume(const size_t o,
+                 std::vector<const char*>::const_iterator& vp);
+    /** Bind the scoped options to the occurrences of the anchors */
+    void bind_scopes(void);
+    /** Find the group of the k-th occurrence and the event in the group */
+    const event* find_scoped(const arg& name, const size_t k) const;
+    /** Check whether an element looks like an option */
+    static bool looks_like_option(const char* s);
+    /** Describe the unknown options in the remaining elements */
+    const arg diagnose_unknown(void) const;
+    /** Call a function for each element of the canonical command line */
+    template <class F>
+    void visit_command_line(const args& names, F f) const;
+    /** Store the registered arguments in the layout of a cache file */
+    void compile_spec(std::vector<char>& out) const;
+    /** Register the arguments stored in the layout of a cache file */
+    bool restore_spec(const char* data, const size_t size, const arg& key);
   };
 
+  bool
+  argparse::is_defined(const arg& dir) const
+  {
+    return find_directive(dir.c_str(), dir.size()) != npos
+      || _preset_index.find(dir) != _preset_index.end()
+      || _passthrough_nargs.find(dir) != _passthrough_nargs.end()
+#if defined(__unix__) || defined(__APPLE__)
+      || _plugin_index.find(dir) != _plugin_index.end()
+#endif
+      ;
+  }
 
   void
-  argparse::format(FILE* output) const
+  argparse::register_option(optional_argument&& o, const bool checked)
   {
-    fprintf(output, "%s ", _appname.c_str());
-    for (auto o : _optional_parsers) if (o.nargs()==0) o.format(output);
-    for (auto o : _optional_parsers) if (o.nargs()>0) o.format(output);
-    for (auto p : _positional_parsers) p.format(output);
-    for (auto o : _optional_parsers) if (o.nargs()<0) o.format(output);
-    fprintf(output, "\n");
+    /**
+     * The directives are indexed at the registration, so that each element
+     * is matched against the options in constant time. The directives are
+     * not checked again if the caller has checked them.
+     */
+    for (auto& d : o.options())
+      if (!checked && is_defined(d))
+        throw std::runtime_error("the directive \"" + d + "\" is defined.");
+    _option_slots.push_back(allocate_slot(o.name(), o.type()));
+    _optional_parsers.push_back(std::move(o));
+    _fingerprinted = false;
+    index_option(_optional_parsers.size()-1);
+    _completed = false;
   }
 
   void
-  argparse::explain(FILE* output) const
+  argparse::compile_index(void)
   {
-    if (_positional_parsers.size()>0) {
-      fprintf(output, "\nArguments\n");
-      for (auto p : _positional_parsers) p.explain(output);
-    }
-    if (_optional_parsers.size()>0) {
-      fprintf(output, "\nOptions\n");
-      for (auto o : _optional_parsers) o.explain(output);
+    size_t ndirs(0), nbytes(0), nbuckets(16);
+    for (auto& o : _optional_parsers) {
+      ndirs += o.options().size();
+      for (auto& d : o.options()) nbytes += d.size()+1;
+      nbytes += o.name().size()+1;
     }
+    while (nbuckets < 2*ndirs) nbuckets *= 2;
+    _strings.clear();
+    _dir_table.assign(nbuckets, 0);
+    _dir_hash.clear();
+    _dir_length.clear();
+    _dir_offset.clear();
+    _dir_option.clear();
+    _opt_nargs.clear();
+    _opt_type.clear();
+    _opt_name.clear();
+    _opt_exit.clear();
+    _strings.reserve(nbytes);
+    _dir_hash.reserve(ndirs);
+    _dir_length.reserve(ndirs);
+    _dir_offset.reserve(ndirs);
+    _dir_option.reserve(ndirs);
+    _opt_nargs.reserve(_optional_parsers.size());
+    _opt_type.reserve(_optional_parsers.size());
+    _opt_name.reserve(_optional_parsers.size());
+    _opt_exit.reserve(_optional_parsers.size());
+    for (size_t i=0; i<_optional_parsers.size(); i++) index_option(i);
+  }
+
+  uint32_t
+  argparse::intern(const arg& str)
+  {
+    const size_t p = _strings.size();
+    if (p+str.size()+1 > std::numeric_limits<uint32_t>::max())
+      throw std::runtime_error("directives are too large.");
+    _strings.insert(_strings.end(), str.c_str(), str.c_str()+str.size()+1);
+    return (uint32_t)p;
   }
 
   void
-  argparse::show_help(FILE* output, const bool simple) const
+  argparse::bucket(const size_t j)
   {
-    if (_description.size() > 0)
-      fprintf(output, "%s\n\n", _description.c_str());
-    fprintf(output, "usage:\n  ");
-    format(output);
-    if (!simple) explain(output);
+    const size_t mask = _dir_table.size()-1;
+    size_t b = _dir_hash[j] & mask;
+    while (_dir_table[b] != 0) b = (b+1) & mask;
+    _dir_table[b] = (uint32_t)j+1;
   }
 
   void
-  argparse::display_status(FILE* output) const
+  argparse::rehash(const size_t nbuckets)
   {
-    fprintf(output, "# input arguments:");
-    for (auto s : _arguments) fprintf(output, " %s", s.c_str());
-    fprintf(output, "\n");
-    fprintf(output, "# defined options: ");
-    for (auto o : _optional_parsers) o.format(output);
-    fprintf(output, "\n");
-    fprintf(output, "# named arguments: ");
-    for (auto p : _positional_parsers) p.format(output);
-    fprintf(output, "\n");
-    fprintf(output, "# parsed arguments:\n");
-    for (auto m : _map) {
-      auto& name = m.first;
-      auto& val  = m.second;
-      fprintf(output, "    %s:", name.c_str());
-      for (auto v : val) {
-        switch (v.type()) {
-        case value_type::Null:
-          fprintf(output, " null"); break;
-        case value_type::Bool:
-          fprintf(output, " %s", (v.get<bool>()==true?"true":"false")); break;
-        case value_type::Integer:
-          fprintf(output, " %ld", v.get<int64_t>()); break;
-        case value_type::Float:
-          fprintf(output, " %lf", v.get<double>()); break;
-        case value_type::String:
-          fprintf(output, " %s", v.get<arg>().c_str()); break;
-        }
+    _dir_table.assign(nbuckets, 0);
+    for (size_t j=0; j<_dir_hash.size(); j++) bucket(j);
+  }
+
+  void
+  argparse::index_option(const size_t i)
+  {
+    /**
+     * The number of the buckets is a power of two at least twice as many
+     * as the directives. The buckets are doubled when they are half full.
+     */
+    auto& o = _optional_parsers[i];
+    for (auto& d : o.options()) {
+      if (2*(_dir_hash.size()+1) > _dir_table.size())
+        rehash(2*_dir_table.size());
+      _dir_hash.push_back(fnv1a(d.data(), d.size()));
+      _dir_length.push_back((uint32_t)d.size());
+      _dir_offset.push_back(intern(d));
+      _dir_option.push_back((uint32_t)i);
+      bucket(_dir_hash.size()-1);
+    }
+    _opt_nargs.push_back(o.nargs());
+    _opt_type.push_back(o.type());
+    _opt_name.push_back(intern(o.name()));
+    _opt_exit.push_back(_slots[_option_slots[i]].exits);
+  }
+
+  size_t
+  argparse::find_directive(const char* s, const size_t n) const
+  {
+    /**
+     * The hashes and the lengths are compared first, and the whole strings
+     * only when they are identical. No element is copied.
+     */
+    const uint64_t h = fnv1a(s, n);
+    const size_t mask = _dir_table.size()-1;
+    ARGPARSE_WORK(n);
+    for (size_t b = h & mask; _dir_table[b] != 0; b = (b+1) & mask) {
+      const size_t i = _dir_table[b]-1;
+      ARGPARSE_WORK(1);
+      if (_dir_hash[i] == h && _dir_length[i] == n
+          && std::memcmp(_strings.data()+_dir_offset[i], s, n) == 0) {
+        ARGPARSE_WORK(n);
+        return _dir_option[i];
       }
-      fprintf(output, "\n");
     }
-    fprintf(output, "\n");
+    return npos;
   }
 
-  template <class T>
-  const std::vector<T>
-  argparse::getall(const arg& name) const
+  size_t
+  argparse::allocate_slot(const arg& name, const value_type type)
   {
-    if (!_completed)
-      throw std::runtime_error("arguments are not parsed.");
+    /** Arguments with the same name share the slot. */
+    auto it = _names.find(name);
+    if (it != _names.end()) return it->second;
+    _names.insert(std::make_pair(name, _slots.size()));
+    slot sl = slot();
+    sl.type = type;
+    _slots.push_back(sl);
+    return _slots.size()-1;
+  }
 
-    std::vector<T> retval;
-    if (_map.find(name) == _map.end())
-      throw std::runtime_error("argument not found.");
-    auto& varr = _map.at(name);
-    for (auto& p : varr)
-      retval.push_back(p.get<T>());
-    return retval;
+  void
+  argparse::merge_names(std::vector<std::pair<const arg*, size_t>>& batch)
+  {
+    /**
+     * The sorted names are inserted in order before the next greater
+     * name, which is searched for only when the hint has fallen behind.
+     */
+    std::sort(batch.begin(), batch.end(),
+              [] (const std::pair<const arg*, size_t>& a,
+                  const std::pair<const arg*, size_t>& b)
+              { return *a.first < *b.first; });
+    auto hint = _names.end();
+    for (auto& b : batch) {
+      if (hint != _names.end() && hint->first < *b.first)
+        hint = _names.lower_bound(*b.first);
+      hint = std::next(_names.emplace_hint(hint, *b.first, b.second));
+    }
   }
 
-  template <class T>
-  const std::vector<T>
-  argparse::getall(const arg& name, const T& dummy) const
+  const argparse::slot*
+  argparse::lookup(const arg& name) const
   {
-    try {
-      return getall<T>(name);
-    } catch (std::exception e) {
-      return std::vector<T>({dummy});
+    auto it = _names.find(name);
+    if (it == _names.end() || !_slots[it->second].found) return nullptr;
+    return &_slots[it->second];
+  }
+
+  const argparse::slot*
+  argparse::read(const arg& name) const
+  {
+    auto it = _names.find(name);
+    if (it == _names.end()) return nullptr;
+    if (it->second < _ncounters)
+      _counters[2*it->second+1].fetch_add(1, std::memory_order_relaxed);
+    if (!_slots[it->second].found) return nullptr;
+    return &_slots[it->second];
+  }
+
+  void
+  argparse::grow_counters(void)
+  {
+    /** The counters are copied, since std::atomic is not movable. */
+    counter_array counters(2*_slots.size());
+    for (size_t i=0; i<2*_ncounters; i++)
+      counters[i].store(_counters[i].load(std::memory_order_relaxed),
+                        std::memory_order_relaxed);
+    _counters.swap(counters);
+    _ncounters = _slots.size();
+  }
+
+  void
+  argparse::set_telemetry(const bool enable)
+  {
+    _counters.reset();
+    _ncounters = 0;
+    _scanned.clear();
+    if (enable) grow_counters();
+  }
+
+  std::vector<usage_counter>
+  argparse::usage(void) const
+  {
+    std::vector<usage_counter> retval;
+    if (!_counters) return retval;
+    retval.reserve(_names.size());
+    for (auto& m : _names) {
+      if (m.second >= _ncounters) {
+        retval.push_back(usage_counter{m.first, 0, 0});
+        continue;
+      }
+      retval.push_back
+        (usage_counter{m.first,
+                       _counters[2*m.second].load(std::memory_order_relaxed),
+                       _counters[2*m.second+1].load(std::memory_order_relaxed)});
     }
+    return retval;
   }
 
-  template <class T>
-  const T argparse::get(const arg& name) const
+  void
+  argparse::save_usage(const arg& path) const
   {
-    if (!_completed)
-      throw std::runtime_error("arguments are not parsed.");
+    arg text;
+    for (auto& u : usage())
+      text += _appname + '\t' + u.name + '\t' + std::to_string(u.given)
+        + '\t' + std::to_string(u.read) + '\n';
+    FILE* fp = fopen(path.c_str(), "a");
+    if (fp == nullptr)
+      throw std::runtime_error("failed to open \"" + path + "\".");
+    const bool ok = (fwrite(text.data(), 1, text.size(), fp) == text.size());
+    if (fclose(fp) != 0 || !ok)
+      throw std::runtime_error("failed to write \"" + path + "\".");
+  }
 
-    if (_map.find(name) == _map.end())
-      throw std::runtime_error("argument not found.");
-    auto& varr = _map.at(name);
-    return varr[0].get<T>();;
+  void
+  argparse::store(const size_t i, const char* s)
+  {
+    /** The values and their strings are overwritten to keep the buffers. */
+    auto& sl = _slots[i];
+    ARGPARSE_WORK(std::strlen(s)+1);
+    if (sl.n >= _limits.max_values)
+      throw std::runtime_error("too many values (limit "
+                               + std::to_string(_limits.max_values) + ").");
+    if (_limits.max_value_bytes != std::numeric_limits<size_t>::max()) {
+      _value_bytes += std::strlen(s)+1;
+      if (_value_bytes > _limits.max_value_bytes)
+        throw std::runtime_error("values are longer than "
+                                 + std::to_string(_limits.max_value_bytes)
+                                 + " bytes in total.");
+    }
+    if (_interpolation && std::strstr(s, "${") != nullptr) {
+      /** The value is validated after the substitution. */
+      const value v(value_type::String, s);
+      if (sl.n < sl.v.size()) sl.v[sl.n] = v; else sl.v.push_back(v);
+      if (_pending.empty() || _pending.back() != i) _pending.push_back(i);
+    } else if (sl.n < sl.v.size()) {
+      sl.v[sl.n] = s;
+    } else {
+      sl.v.push_back(value(sl.type, s));
+    }
+    sl.n++;
   }
 
-  template <class T>
-  const T argparse::get(const arg& name, const T& dummy) const
+  void
+  argparse::validate(const value_type type, const char* s) const
   {
+    ARGPARSE_WORK(std::strlen(s)+1);
+    if (_interpolation && std::strstr(s, "${") != nullptr) return;
+    value(type, s);
+  }
+
+  void
+  argparse::interpolate(void)
+  {
+    if (_pending.empty()) return;
+    _visit.assign(_slots.size(), 0);
     try {
-      return argparse::get<T>(name);
-    } catch (std::runtime_error e) {
-      return dummy;
+      for (auto k : _pending) resolve(k);
+    } catch (std::runtime_error&) {
+      /** The placeholders are dropped so that no buffer keeps the type. */
+      for (auto k : _pending) {
+        auto& sl = _slots[k];
+        sl.v.erase(std::remove_if(sl.v.begin(), sl.v.end(),
+                                  [&sl] (const value& v)
+                                  { return v.type() != sl.type; }),
+                   sl.v.end());
+        sl.n = std::min(sl.n, sl.v.size());
+      }
+      _pending.clear();
+      throw;
     }
+    _pending.clear();
   }
 
   void
-  argparse::parse(const bool help_on_error,
-                  const bool show_help_and_exit)
+  argparse::resolve(const size_t k)
   {
-    auto optsort =
-      [] (const optional_argument &a, const optional_argument &b)
-      { return a.nargs()>b.nargs(); };
-    auto& _pp = _positional_parsers;
-    auto& _op = _optional_parsers;
-    std::vector<arg> _remaining;
-    //std::sort(_op.begin(), _op.end(), optsort);
-    try {
-      {
-        /**
-         * At the beginning, all the optional arguments are processed.
-         * When the conversion of an element is failed, it throws
-         * std::runtime_error immediately.
-         */
-        auto vp = _arguments.begin();
-        while (vp != _arguments.end()) {
-          bool _updated(false);
-          for (auto& o : _op) {
-            const auto& size = o.nargs();
-            const auto& name = o.name();
-            const auto& type = o.type();
-            const auto& vtrue = values{value(value_type::Bool, "true")};
-            values v;
-
-            if (vp == _arguments.end()) break;
-            if (o==*vp) {
-              _updated = true;
-              vp++;
-              if (size == 0) {
-                _map.insert(argument(name,vtrue));
-              } else if (size >= 1) {
-                for (auto i=0; i<size; i++) {
-                  v.push_back(value(type, *vp)); vp++;
-                }
-                _map.insert(argument(name,v));
-              } else if (size == variable_args) {
-                while (vp != _arguments.end()) {
-                  auto q = std::find(_op.begin(),_op.end(), *vp);
-                  if (q != _op.end()) break;
-                  v.push_back(value(type, *vp)); vp++;
-                }
-                _map.insert(argument(name,v));
-              }
-            }
-          }
+    /** The slots are resolved in the depth-first order. */
+    auto name = [this] (const size_t k) {
+      for (auto& m : _names) if (m.second == k) return m.first;
+      return arg();
+    };
+    if (_visit[k] == 2) return;
+    if (_visit[k] == 1)
+      throw std::runtime_error("circular reference to \"" + name(k) + "\"");
+    _visit[k] = 1;
 
-          if (!_updated) {
-            _remaining.push_back(*vp);
-            vp++;
-          }
+    auto& sl = _slots[k];
+    for (size_t i=0; i<sl.n; i++) {
+      const arg& src = sl.v[i].str();
+      if (src.find("${") == arg::npos) continue;
+      arg dst;
+      size_t p(0);
+      for (;;) {
+        const size_t b = src.find("${", p);
+        if (b == arg::npos) { dst.append(src, p, arg::npos); break; }
+        const size_t e = src.find('}', b+2);
+        if (e == arg::npos)
+          throw std::runtime_error("unterminated reference in \"" + src + "\"");
+        dst.append(src, p, b-p);
+        const arg ref = src.substr(b+2, e-b-2);
+        auto it = _names.find(ref);
+        const char* env;
+        if (it != _names.end() && _slots[it->second].n > 0) {
+          resolve(it->second);
+          dst += _slots[it->second].v[0].str();
+        } else if ((env = std::getenv(ref.c_str())) != nullptr) {
+          dst += env;
+        } else {
+          throw std::runtime_error("undefined reference to \"" + ref + "\"");
         }
+        p = e+1;
       }
-      {
-        /**
-         * The remaining elements are processed as positional arguments.
-         * When the conversion of an element is failed, it throws
-         * std::runtime_error immediately.
-         */
-        auto vp = _remaining.begin();
-        auto ip = _pp.begin();
-        while (ip != _pp.end()) {
-          if (vp == _remaining.end())
-            throw std::runtime_error("insufficient number of arguments");
+      ARGPARSE_WORK(src.size()+dst.size());
+      sl.v[i] = value(sl.type, dst);
+    }
+    _visit[k] = 2;
+  }
 
-          const auto& size = ip->nargs();
-          const auto& name = ip->name();
-          const auto& type = ip->type();
-          values v;
+  void
+  argparse::add_passthrough(const arg& dir, const int16_t n)
+  {
+    if (n < 0)
+      throw std::runtime_error("the number of the values is negative.");
+    if (is_defined(dir))
+      throw std::runtime_error("the directive \"" + dir + "\" is defined.");
+    _passthrough_nargs[dir] = n;
+  }
 
-          if (size >= 1) {
-            for (auto i=0; i<size; i++) {
-              if (vp == _remaining.end())
-                throw std::runtime_error("insufficient number of arguments");
-              v.push_back(value(type, *vp)); vp++;
-            }
-          } else if (size == variable_args) {
-            while (vp != _remaining.end()) {
-              v.push_back(value(type, *vp)); vp++;
-            }
-          }
-          _map.insert(argument(name,v));
-          ip++;
+  void
+  argparse::add_preset(const arg& dir, const args& elements, const arg& com)
+  {
+    /** The tokens point into the elements of the presets. */
+    if (_tokenized)
+      throw std::runtime_error("a preset cannot be added after parsing.");
+    if (is_defined(dir))
+      throw std::runtime_error("the directive \"" + dir + "\" is defined.");
+
+    /** The elements are flattened with the registered presets. */
+    auto flatten = [this] (const args& src, const arg& self) {
+      args dst;
+      for (auto& e : src) {
+        auto it = _preset_index.find(e);
+        if (it == _preset_index.end()) {
+          dst.push_back(e);
+        } else {
+          auto& sub = _presets[it->second].elements;
+          dst.insert(dst.end(), sub.begin(), sub.end());
         }
       }
-      /**
-       * `_completed` flag is set `true` when all the conversion is
-       * successfully completed. After that `get()` and `getall()` functions
-       * are enabled.
-       */
-      _completed = true;
-    } catch (std::runtime_error e) {
-      /**
-       * If `help_on_error` is set `true`, `parse()` function catches any
-       * exception, displays a simplified help message, and exits.
-       */
-      if (help_on_error) {
-        _completed = true; // unlock the `get` function
-        if (get<bool>("help", false)) {
-          show_help(stderr, false);
-          exit(EXIT_SUCCESS);
+      if (std::find(dst.begin(), dst.end(), self) != dst.end())
+        throw std::runtime_error("the preset \"" + self + "\" is recursive.");
+      return dst;
+    };
+    preset p{dir, com, flatten(elements, dir)};
+
+    /** The presets which refer to the new directive are updated. */
+    for (auto& q : _presets) {
+      if (std::find(q.elements.begin(), q.elements.end(), dir)
+          == q.elements.end()) continue;
+      args dst;
+      for (auto& e : q.elements) {
+        if (e == dir) {
+          dst.insert(dst.end(), p.elements.begin(), p.elements.end());
         } else {
-          show_help(stderr, true);
-          fprintf(stderr, "\nerror: %s\n", e.what());
-          exit(EXIT_FAILURE);
+          dst.push_back(e);
         }
       }
-      throw;
+      q.elements.swap(dst);
+    }
+    _preset_index.insert(std::make_pair(dir, _presets.size()));
+    _presets.push_back(p);
+    _completed = false;
+    _fingerprinted = false;
+    _tokenized = false;
+  }
+
+  void
+  argparse::add_scoped_option(const std::vector<arg>& dirs, const arg& name,
+                              const value_type type, const int16_t n,
+                              const arg& anchor, const scope_type scope,
+                              const arg& com)
+  {
+    /** A shared slot would lose the role of the anchor. */
+    if (_names.find(name) != _names.end())
+      throw std::runtime_error("the name \"" + name + "\" is defined.");
+    auto a = _names.find(anchor);
+    if (a == _names.end() || name == anchor)
+      throw std::runtime_error("the anchor \"" + anchor + "\" is not defined.");
+    if (_slots[a->second].role == 2)
+      throw std::runtime_error("a scoped option cannot be an anchor.");
+    add_option(dirs, name, type, n, com);
+    auto& sl = _slots[_option_slots.back()];
+    sl.role = 2;
+    sl.scope = scope;
+    sl.anchor = a->second;
+    _slots[a->second].role = 1;
+    _fingerprinted = false;
+  }
+
+  void
+  argparse::add_exit_option(const args& dirs, const arg& name,
+                            const arg& com)
+  {
+    add_option(dirs, name, value_type::Bool, 0, com);
+    _slots[_option_slots.back()].exits = true;
+    _opt_exit.back() = 1;
+    _fingerprinted = false;
+  }
+
+  void
+  argparse::consume(const size_t o,
+                    std::vector<const char*>::const_iterator& vp)
+  {
+    /** The tables may grow while the values are expanded by plugins. */
+    const int16_t size = _opt_nargs[o];
+    const value_type type = _opt_type[o];
+    const size_t k = _option_slots[o];
+    auto claimed = [&] (void) {
+      return (!available(vp) || _claimed[vp-_tokens.begin()]);
+    };
+    /** Only the first occurrence is stored. The others are checked. */
+    const bool stored = _slots[k].found;
+    /** All the occurrences are recorded for the scoped options. */
+    const bool scoped = (_slots[k].role != 0);
+    auto push = [&] (const char* s) {
+      if (stored) validate(type, s); else store(k, s);
+      if (scoped) {
+        _scoped_elements.push_back(s);
+        _events.back().count++;
+      }
+    };
+    _slots[k].found = true;
+    _claimed[vp-_tokens.begin()-1] = 1;
+    if (scoped)
+      _events.push_back(event{k, (size_t)(vp-_tokens.begin()-1),
+                              _scoped_elements.size(), 0});
+
+    if (size == 0) {
+      push("true");
+    } else if (size >= 1) {
+      for (auto i=0; i<size; i++) {
+        if (claimed())
+          throw std::runtime_error("insufficient number of arguments");
+        push(*vp);
+        _claimed[vp-_tokens.begin()] = 1; vp++;
+      }
+    } else if (size == variable_args) {
+      while (!claimed()) {
+        if (find_directive(*vp) != npos) break;
+        push(*vp);
+        _claimed[vp-_tokens.begin()] = 1; vp++;
+      }
+    }
+  }
+
+  void
+  argparse::bind_scopes(void)
+  {
+    const size_t none = std::numeric_limits<size_t>::max();
+    _groups.clear();
+    _group_order.clear();
+    _bindings.clear();
+    for (auto& sl : _slots) sl.ngroups = 0;
+    /** The events of the positional arguments are recorded later. */
+    std::stable_sort(_events.begin(), _events.end(),
+                     [] (const event& a, const event& b)
+                     { return a.position < b.position; });
+    _event_group.assign(_events.size(), none);
+    ARGPARSE_WORK(_events.size()+_slots.size());
+    for (auto& sl : _slots) sl.cursor = none;
+
+    /**
+     * The occurrences of the anchors make groups in order. The scoped
+     * options are bound to the previous group in the forward scan and to
+     * the next group in the backward scan.
+     */
+    for (size_t i=0; i<_events.size(); i++) {
+      auto& sl = _slots[_events[i].slot];
+      if (sl.role == 1) {
+        _event_group[i] = _groups.size();
+        sl.cursor = _groups.size();
+        _groups.push_back(group{i, 0, 0});
+      } else if (sl.scope == scope_type::Previous) {
+        _event_group[i] = _slots[sl.anchor].cursor;
+      }
+    }
+    for (auto& sl : _slots) sl.cursor = none;
+    for (size_t i=_events.size(); i-- > 0;) {
+      auto& sl = _slots[_events[i].slot];
+      if (sl.role == 1) {
+        sl.cursor = _event_group[i];
+      } else if (sl.scope == scope_type::Next) {
+        _event_group[i] = _slots[sl.anchor].cursor;
+      }
+      if (_event_group[i] == none)
+        throw std::runtime_error("a scoped option is not bound to any anchor.");
+    }
+
+    /** The bindings and the groups are sorted by the counting sort. */
+    for (size_t i=0; i<_events.size(); i++)
+      if (_slots[_events[i].slot].role == 2) _groups[_event_group[i]].end++;
+    size_t p(0);
+    for (auto& g : _groups) {
+      g.begin = p;
+      p += g.end;
+      g.end = g.begin;
+    }
+    _bindings.resize(p);
+    for (size_t i=0; i<_events.size(); i++)
+      if (_slots[_events[i].slot].role == 2)
+        _bindings[_groups[_event_group[i]].end++] = i;
+
+    for (auto& g : _groups) _slots[_events[g.event].slot].ngroups++;
+    p = 0;
+    for (auto& sl : _slots) {
+      sl.first_group = p;
+      p += sl.ngroups;
+      sl.cursor = sl.first_group;
+    }
+    _group_order.resize(_groups.size());
+    for (size_t i=0; i<_groups.size(); i++)
+      _group_order[_slots[_events[_groups[i].event].slot].cursor++] = i;
+  }
+
+  size_t
+  argparse::occurrences(const arg& anchor) const
+  {
+    if (!_completed)
+      throw std::runtime_error("arguments are not parsed.");
+    auto sl = lookup(anchor);
+    return (sl == nullptr)?0:sl->ngroups;
+  }
+
+  const argparse::event*
+  argparse::find_scoped(const arg& name, const size_t k) const
+  {
+    if (!_completed)
+      throw std::runtime_error("arguments are not parsed.");
+    auto sl = lookup(name);
+    if (sl == nullptr || sl->role == 0) return nullptr;
+    auto& a = (sl->role == 1)?*sl:_slots[sl->anchor];
+    if (k >= a.ngroups) return nullptr;
+    auto& g = _groups[_group_order[a.first_group+k]];
+    if (sl->role == 1) return &_events[g.event];
+    const size_t i = sl - _slots.data();
+    for (size_t b=g.begin; b<g.end; b++)
+      if (_events[_bindings[b]].slot == i) return &_events[_bindings[b]];
+    return nullptr;
+  }
+
+  template <class T>
+  const std::vector<T>
+  argparse::getall_scoped(const arg& name, const size_t k) const
+  {
+    auto e = find_scoped(name, k);
+    if (e == nullptr)
+      throw std::runtime_error("argument not found.");
+    const auto& type = _slots[e->slot].type;
+    std::vector<T> retval;
+    for (size_t i=0; i<e->count; i++)
+      retval.push_back(value(type, _scoped_elements[e->first+i]).get<T>());
+    return retval;
+  }
+
+  template <class T>
+  const T
+  argparse::get_scoped(const arg& name, const size_t k) const
+  {
+    auto e = find_scoped(name, k);
+    if (e == nullptr || e->count == 0)
+      throw std::runtime_error("argument not found.");
+    return value(_slots[e->slot].type, _scoped_elements[e->first]).get<T>();
+  }
+
+  template <class T>
+  const T
+  argparse::get_scoped(const arg& name, const size_t k, const T& dummy) const
+  {
+    try {
+      return get_scoped<T>(name, k);
+    } catch (std::runtime_error& e) {
+      return dummy;
+    }
+  }
+
+#if defined(__unix__) || defined(__APPLE__)
+  void
+  argparse::add_plugin(const arg& path, const args& dirs, const arg& symbol)
+  {
+    for (auto& d : dirs) {
+      if (is_defined(d))
+        throw std::runtime_error("the directive \"" + d + "\" is defined.");
+    }
+    for (auto& d : dirs)
+      _plugin_index.insert(std::make_pair(d, _plugins.size()));
+    _plugins.push_back(plugin{path, symbol, nullptr});
+  }
+
+  void
+  argparse::load_plugin(const size_t i)
+  {
+    auto& p = _plugins[i];
+    if (p.handle != nullptr) return;
+    void* handle = dlopen(p.path.c_str(), RTLD_NOW|RTLD_LOCAL);
+    if (handle == nullptr)
+      throw std::runtime_error("failed to load \"" + p.path + "\": "
+                               + dlerror());
+    auto f = reinterpret_cast<plugin_function>(dlsym(handle, p.symbol.c_str()));
+    if (f == nullptr) {
+      dlclose(handle);
+      throw std::runtime_error("\"" + p.symbol + "\" is not found in \""
+                               + p.path + "\".");
+    }
+    /**
+     * The handle is never closed, since the plugin may be referred to by
+     * the registered arguments.
+     */
+    p.handle = handle;
+    /** The directives in the manifest are registered by the plugin. */
+    for (auto it = _plugin_index.begin(); it != _plugin_index.end();)
+      it = (it->second == i)?_plugin_index.erase(it):std::next(it);
+    f(*this);
+  }
+
+  void
+  argparse::load_plugins(void)
+  {
+    for (size_t i=0; i<_plugins.size(); i++) load_plugin(i);
+  }
+
+  void
+  argparse::load_requested_plugins(const size_t first)
+  {
+    bool help(false);
+    for (size_t i=first; i<_tokens.size(); i++) {
+      if (_claimed[i]) continue;
+      auto it = _plugin_index.find(_key.assign(_tokens[i]));
+      if (it != _plugin_index.end()) {
+        load_plugin(it->second);
+        continue;
+      }
+      auto d = find_directive(_tokens[i]);
+      if (d != npos && _optional_parsers[d].name() == "help") help = true;
+    }
+    /** All the plugins are required to show the full help message. */
+    if (help) load_plugins();
+  }
+#endif
+
+  void
+  argparse::check_token(const char* s) const
+  {
+    /** The element is scanned up to the budget, not to the end. */
+    size_t n(0);
+    while (s[n] != '\0')
+      if (n++ == _limits.max_token_bytes)
+        throw std::runtime_error("an element is longer than "
+                                 + std::to_string(_limits.max_token_bytes)
+                                 + " bytes.");
+  }
+
+  argparse::response
+  argparse::read_response(const arg& path, std::atomic<size_t>& budget)
+  {
+    /** A file is not read beyond the bytes left for all the files. */
+    const size_t unlimited = std::numeric_limits<size_t>::max();
+    response r;
+    FILE* fp = fopen(path.c_str(), "rb");
+    if (fp == nullptr)
+      throw std::runtime_error("failed to open \"" + path + "\".");
+    char chunk[65536];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), fp)) > 0) {
+      size_t left = budget.load(std::memory_order_relaxed);
+      while (left != unlimited) {
+        if (n > left) {
+          fclose(fp);
+          throw std::runtime_error("\"" + path + "\" exceeds the budget of "
+                                   "the response files.");
+        }
+        if (budget.compare_exchange_weak(left, left-n)) break;
+      }
+      r.text.insert(r.text.end(), chunk, chunk+n);
+    }
+    fclose(fp);
+    r.text.push_back('\0');
+
+    /** The elements are unquoted in place and terminated by NUL. */
+    char* w = r.text.data();
+    const char* p = r.text.data();
+    while (*p != '\0') {
+      if (std::isspace((unsigned char)*p)) { p++; continue; }
+      r.elements.push_back(w);
+      while (*p != '\0' && !std::isspace((unsigned char)*p)) {
+        if (*p == '"' || *p == '\'') {
+          const char q = *p++;
+          while (*p != '\0' && *p != q) *w++ = *p++;
+          if (*p == '\0')
+            throw std::runtime_error("unterminated quote in \"" + path + "\".");
+          p++;
+        } else {
+          *w++ = *p++;
+        }
+      }
+      const bool end = (*p == '\0');
+      *w++ = '\0';
+      if (end) break;
+      p++;
+    }
+    return r;
+  }
+
+  void
+  argparse::load_responses(void)
+  {
+    /**
+     * Each file is read by an asynchronous task, and at most `max_loads`
+     * tasks run at once. A finished task pushes the file to a queue and
+     * signals the condition, and the files referred to by it are
+     * requested at once. The tasks are joined before returning.
+     */
+    const size_t max_loads = 8;
+    _responses.clear();
+    /** The files share the budget, derived from the elements if unset. */
+    const size_t unlimited = std::numeric_limits<size_t>::max();
+    size_t bytes = _limits.max_response_bytes;
+    if (bytes == unlimited && _limits.max_tokens != unlimited
+        && _limits.max_token_bytes != unlimited
+        && _limits.max_tokens <= unlimited/(_limits.max_token_bytes+2))
+      bytes = _limits.max_tokens*(_limits.max_token_bytes+1);
+    std::atomic<size_t> budget(bytes);
+    struct loaded {
+      arg path;                  /**< The path to the file */
+      size_t depth;              /**< The depth of the first reference */
+      response file;             /**< The elements of the file */
+      std::exception_ptr error;  /**< The error in reading the file */
+    };
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::vector<loaded> done;
+    /** The tasks are destroyed first, so that they are joined. */
+    std::vector<std::future<void>> tasks;
+    /**
+     * A file is loaded at the depth of the first reference found. Every
+     * reference is spliced later, so a file over the depth is an error.
+     */
+    std::map<arg, size_t> requested;
+    std::vector<std::pair<arg, size_t>> waiting;
+    size_t next(0), running(0), nelements(0);
+    auto request = [&] (const char* e, const size_t depth) {
+      if (e[0] != '@' || e[1] == '\0') return;
+      const arg path(e+1);
+      if (requested.count(path)) return;
+      if (depth > _limits.max_depth)
+        throw std::runtime_error("response files are nested deeper than "
+                                 + std::to_string(_limits.max_depth) + ".");
+      requested.insert(std::make_pair(path, depth));
+      waiting.push_back(std::make_pair(path, depth));
+    };
+    auto load = [&] (const arg path, const size_t depth) {
+      loaded l{path, depth, response(), nullptr};
+      try {
+        l.file = read_response(path, budget);
+      } catch (...) {
+        l.error = std::current_exception();
+      }
+      std::lock_guard<std::mutex> lock(mutex);
+      done.push_back(std::move(l));
+      ready.notify_one();
+    };
+    auto start = [&] (void) {
+      for (; running < max_loads && next < waiting.size(); next++, running++)
+        tasks.push_back(std::async(std::launch::async, load,
+                                   waiting[next].first, waiting[next].second));
+    };
+    for (auto a : _arguments) request(a, 1);
+    start();
+    std::vector<loaded> batch;
+    while (running > 0) {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        ready.wait(lock, [&] { return !done.empty(); });
+        batch.swap(done);
+      }
+      running -= batch.size();
+      for (auto& l : batch) {
+        if (l.error) std::rethrow_exception(l.error);
+        nelements += l.file.elements.size();
+        if (nelements > _limits.max_tokens)
+          throw std::runtime_error("too many elements (limit "
+                                   + std::to_string(_limits.max_tokens)
+                                   + ").");
+        auto& stored = _responses[l.path];
+        stored = std::move(l.file);
+        for (auto e : stored.elements) request(e, l.depth+1);
+      }
+      batch.clear();
+      start();
     }
+  }
+
+  void
+  argparse::tokenize(void)
+  {
+    _tokens.clear();
+    _claimed.clear();
+    _cursor = 0;
+    _tokenized = true;
+    if (_arguments.size() > _limits.max_tokens)
+      throw std::runtime_error("too many elements (limit "
+                               + std::to_string(_limits.max_tokens) + ").");
+    if (_response_files) load_responses();
+    expand();
+  }
+
+  void
+  argparse::expand(void)
+  {
     /**
-     * If `show_help_and_exit` is set `true` and `help` argument is defined,
-     * it displays a detailed help message and exits normally.
+     * The elements are spliced as pointers to the flattened presets and
+     * to the loaded response files, so that no element is copied or
+     * tokenized again. The chunks double in size, and the rest is not
+     * expanded when parsing stops at an exit option.
      */
-    if (show_help_and_exit && get<bool>("help", false)) {
-      show_help(stderr, false);
-      exit(EXIT_SUCCESS);
+    const size_t chunk = std::max<size_t>(64, _tokens.size());
+    const size_t target = _tokens.size()+chunk;
+    const size_t unlimited = std::numeric_limits<size_t>::max();
+    const bool checked = (_limits.max_token_bytes != unlimited);
+    auto overflow = [this] (void) {
+      return std::runtime_error("too many elements (limit "
+                                + std::to_string(_limits.max_tokens) + ").");
+    };
+    auto push = [&] (const char* a) {
+      ARGPARSE_WORK(1);
+      if (checked) check_token(a);
+      auto it = _presets.empty()?_preset_index.end()
+        :_preset_index.find(_key.assign(a));
+      if (it == _preset_index.end()) {
+        if (_tokens.size() >= _limits.max_tokens) throw overflow();
+        _tokens.push_back(a);
+      } else {
+        if (_presets[it->second].elements.size()
+            > _limits.max_tokens-_tokens.size()) throw overflow();
+        for (auto& e : _presets[it->second].elements)
+          _tokens.push_back(e.c_str());
+      }
+    };
+    if (_response_files) {
+      /** The files are expanded depth-first in the order of the inputs. */
+      struct frame { const arg* path; const response* file; size_t next; };
+      std::vector<frame> stack;
+      while (_cursor < _arguments.size() && _tokens.size() < target) {
+        const char* e = _arguments.first[_cursor++];
+        for (;;) {
+          if (e[0] != '@' || e[1] == '\0') {
+            push(e);
+          } else {
+            auto it = _responses.find(arg(e+1));
+            for (auto& f : stack)
+              if (f.path == &it->first)
+                throw std::runtime_error("circular reference to \""
+                                         + it->first + "\".");
+            /** A file loaded shallower may be spliced deeper. */
+            if (stack.size() >= _limits.max_depth)
+              throw std::runtime_error
+                ("response files are nested deeper than "
+                 + std::to_string(_limits.max_depth) + ".");
+            stack.push_back(frame{&it->first, &it->second, 0});
+          }
+          while (!stack.empty()
+                 && stack.back().next == stack.back().file->elements.size())
+            stack.pop_back();
+          if (stack.empty()) break;
+          e = stack.back().file->elements[stack.back().next++];
+        }
+      }
+    } else if (_presets.empty()) {
+      const size_t n = std::min(_arguments.size()-_cursor, chunk);
+      const char** first = _arguments.first+_cursor;
+      if (checked) for (size_t i=0; i<n; i++) check_token(first[i]);
+      ARGPARSE_WORK(n);
+      _tokens.insert(_tokens.end(), first, first+n);
+      _cursor += n;
+    } else {
+      while (_cursor < _arguments.size() && _tokens.size() < target)
+        push(_arguments.first[_cursor++]);
+    }
+    _claimed.resize(_tokens.size(), 0);
+  }
+
+  bool
+  argparse::available(std::vector<const char*>::const_iterator& vp)
+  {
+    if (vp != _tokens.end()) return true;
+    if (_cursor == _arguments.size()) return false;
+    const size_t i = vp-_tokens.begin();
+    expand();
+#if defined(__unix__) || defined(__APPLE__)
+    if (!_plugins.empty()) load_requested_plugins(i);
+#endif
+    vp = _tokens.begin()+i;
+    return (vp != _tokens.end());
+  }
+
+  void
+  argparse::reset(void)
+  {
+    /** The options counted by `prescan()` are counted again if parsed. */
+    for (auto k : _scanned)
+      if (k < _ncounters)
+        _counters[2*k].fetch_sub(1, std::memory_order_relaxed);
+    _scanned.clear();
+    for (auto& sl : _slots) {
+      sl.n = 0;
+      sl.found = false;
+      sl.ngroups = 0;
+    }
+    _remaining.clear();
+    _remaining_index.clear();
+    _pending.clear();
+    _events.clear();
+    _scoped_elements.clear();
+    _groups.clear();
+    _group_order.clear();
+    _bindings.clear();
+    _passthrough.resize(1);
+    _passthrough[0] = _argv0;
+    _claimed.assign(_tokens.size(), 0);
+    _exit.clear();
+    _exit_at = npos;
+    _value_bytes = 0;
+    _completed = false;
+    _prescanned = false;
+  }
+
+  void
+  argparse::rewind(void)
+  {
+    if (!_tokenized) tokenize();
+    /** The options counted by `prescan()` are kept. */
+    _scanned.clear();
+    /** The positional slots are marked to drop their events at once. */
+    std::vector<uint8_t> positional(_events.empty()?0:_slots.size(), 0);
+    for (auto k : _positional_slots) {
+      if (!positional.empty()) positional[k] = 1;
+      if (_limits.max_value_bytes != std::numeric_limits<size_t>::max())
+        for (size_t i=0; i<_slots[k].n; i++)
+          _value_bytes -= _slots[k].v[i].str().size()+1;
+      _slots[k].n = 0;
+      _slots[k].found = false;
+    }
+    _events.erase(std::remove_if(_events.begin(), _events.end(),
+                                 [&] (const event& e)
+                                 { return positional[e.slot] != 0; }),
+                  _events.end());
+    _remaining.clear();
+    _remaining_index.clear();
+    _pending.clear();
+    _passthrough.resize(1);
+    _passthrough[0] = _argv0;
+    /** The switch given to stop is kept, since it is already claimed. */
+    _completed = false;
+    _prescanned = false;
+  }
+
+  void
+  argparse::resume(const bool help_on_error, const bool show_help_and_exit)
+  {
+    rewind();
+    process(help_on_error, show_help_and_exit);
+  }
+
+  void
+  argparse::prescan(const args& names)
+  {
+    reset();
+    if (!_tokenized) tokenize();
+    /** All the elements are scanned, even after an exit option. */
+    while (_cursor < _arguments.size()) expand();
+
+    std::vector<size_t> targets;
+    for (auto& name : names) {
+      size_t i(0);
+      while (i < _opt_name.size()
+             && name.compare(_strings.data()+_opt_name[i]) != 0) i++;
+      if (i == _opt_name.size())
+        throw std::runtime_error("option \"" + name + "\" is not defined.");
+      targets.push_back(i);
+    }
+
+    std::vector<const char*>::const_iterator vp = _tokens.begin();
+    while (vp != _tokens.end()) {
+      auto d = find_directive(*vp);
+      vp++;
+      if (d == npos
+          || std::find(targets.begin(), targets.end(), d) == targets.end())
+        continue;
+      consume(d, vp);
+      if (_counters) {
+        count(_option_slots[d]);
+        _scanned.push_back(_option_slots[d]);
+      }
     }
+    interpolate();
+    _prescanned = true;
   }
+
+  bool
+  argparse::looks_like_option(const char* s)
+  {
+    if (s[0] != '-' || s[1] == '\0') return false;
+    /** negative numbers are not recognized as options */
+    char* end;
+    std::strtod(s, &end);
+    return (*end != '\0');
+  }
+
+
+  /**
+   * @brief Calculate the Levenshtein distance with Myers' algorithm.
+   * @param[in] peq The bit-vectors of the pattern for each character.
+   * @param[in] m The length of the pattern (at most 64).
+   * @param[in] t The text compared with the pattern.
+   * @param[in] n The length of the text.
+   * @return The edit distance between the pattern and the text.
+   */
+  inline size_t
+  edit_distance(const uint64_t* peq, const size_t m,
+                const char* t, const size_t n)
+  {
+    const uint64_t last = (uint64_t)1<<(m-1);
+    uint64_t pv = ~(uint64_t)0, mv = 0;
+    ARGPARSE_WORK(n);
+    size_t score = m;
+    for (size_t j=0; j<n; j++) {
+      const uint64_t eq = peq[(unsigned char)t[j]];
+      const uint64_t xv = eq | mv;
+      const uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+      uint64_t ph = mv | ~(xh | pv);
+      uint64_t mh = pv & xh;
+      if (ph & last) score++;
+      else if (mh & last) score--;
+      /** the first row increases by one in the global alignment */
+      ph = (ph << 1) | 1;
+      mh = (mh << 1);
+      pv = mh | ~(xv | ph);
+      mv = ph & xv;
+    }
+    return score;
+  }
+
+  args
+  argparse::suggest(const arg& s, const size_t max) const
+  {
+    const size_t m = s.size();
+    if (m == 0 || m > 64) return args();
+
+    uint64_t peq[256] = {0};
+    for (size_t i=0; i<m; i++) peq[(unsigned char)s[i]] |= (uint64_t)1<<i;
+    /** Only a few edits are regarded as a typo. */
+    const size_t limit = std::max<size_t>(1, m/3);
+
+    /** The directives are read from the string table in place. */
+    std::vector<std::pair<size_t, const char*>> candidates;
+    for (size_t i=0; i<_dir_offset.size(); i++) {
+      const size_t n = _dir_length[i];
+      if ((n>m?n-m:m-n) > limit) continue;
+      const char* d = _strings.data()+_dir_offset[i];
+      const size_t dist = edit_distance(peq, m, d, n);
+      if (dist <= limit && dist > 0)
+        candidates.push_back(std::make_pair(dist, d));
+    }
+    /** The directives at the same distance are sorted by bytes. */
+    std::sort(candidates.begin(), candidates.end(),
+              [] (const std::pair<size_t, const char*>& a,
+                  const std::pair<size_t, const char*>& b)
+              { return (a.first != b.first)?(a.first < b.first):
+                  (std::strcmp(a.second, b.second) < 0); });
+
+    args retval;
+    for (auto& c : candidates) {
+      if (retval.size() >= max) break;
+      retval.push_back(c.second);
+    }
+    return retval;
+  }
+
+  const arg
+  argparse::diagnose_unknown(void) const
+  {
+    arg msg;
+    for (auto r : _remaining) {
+      if (!looks_like_option(r)) continue;
+      msg += "\nunknown option '" + arg(r) + "'";
+      auto s = suggest(r);
+      for (size_t i=0; i<s.size(); i++)
+        msg += (i==0?"; did you mean '":" or '") + s[i] + "'";
+      if (s.size() > 0) msg += "?";
+    }
+    return msg;
+  }
+
+  void
+  argparse::format(FILE* output) const
+  {
+    fprintf(output, "%s ", _appname.c_str());
+    for (auto o : _optional_parsers) if (o.nargs()==0) o.format(output);
+    for (auto o : _optional_parsers) if (o.nargs()>0) o.format(output);
+    for (auto p : _positional_parsers) p.format(output);
+    for (auto o : _optional_parsers) if (o.nargs()<0) o.format(output);
+    fprintf(output, "\n");
+  }
+
+  void
+  argparse::explain(FILE* output) const
+  {
+    if (_positional_parsers.size()>0) {
+      fprintf(output, "\nArguments\n");
+      for (auto p : _positional_parsers) p.explain(output);
+    }
+    if (_optional_parsers.size()>0) {
+      fprintf(output, "\nOptions\n");
+      for (auto o : _optional_parsers) o.explain(output);
+    }
+    if (_presets.size()>0) {
+      fprintf(output, "\nPresets\n");
+      for (auto& p : _presets) {
+        fprintf(output, "  %s:\n        =", p.directive.c_str());
+        for (auto& e : p.elements) fprintf(output, " %s", e.c_str());
+        fprintf(output, "\n");
+        if (p.comment.size()>0)
+          fprintf(output, "        %s\n", p.comment.c_str());
+      }
+    }
+  }
+
+  void
+  argparse::show_help(FILE* output, const bool simple) const
+  {
+    if (_description.size() > 0)
+      fprintf(output, "%s\n\n", _description.c_str());
+    fprintf(output, "usage:\n  ");
+    format(output);
+    if (!simple) explain(output);
+  }
+
+  void
+  argparse::display_status(FILE* output) const
+  {
+    fprintf(output, "# input arguments:");
+    for (auto s : _arguments) fprintf(output, " %s", s);
+    fprintf(output, "\n");
+    fprintf(output, "# defined options: ");
+    for (auto o : _optional_parsers) o.format(output);
+    fprintf(output, "\n");
+    fprintf(output, "# named arguments: ");
+    for (auto p : _positional_parsers) p.format(output);
+    fprintf(output, "\n");
+    fprintf(output, "# parsed arguments:\n");
+    for (auto& m : _names) {
+      auto& name = m.first;
+      auto& sl   = _slots[m.second];
+      if (!sl.found) continue;
+      fprintf(output, "    %s:", name.c_str());
+      for (size_t i=0; i<sl.n; i++) {
+        auto& v = sl.v[i];
+        switch (v.type()) {
+        case value_type::Null:
+          fprintf(output, " null"); break;
+        case value_type::Bool:
+          fprintf(output, " %s", (v.get<bool>()==true?"true":"false")); break;
+        case value_type::Integer:
+          fprintf(output, " %ld", v.get<int64_t>()); break;
+        case value_type::Float:
+          fprintf(output, " %lf", v.get<double>()); break;
+        case value_type::String:
+          fprintf(output, " %s", v.get<arg>().c_str()); break;
+        }
+      }
+      fprintf(output, "\n");
+    }
+    fprintf(output, "\n");
+  }
+
+  template <class F>
+  void
+  argparse::visit_command_line(const args& names, F f) const
+  {
+    auto selected = [&] (const arg& name) {
+      if (lookup(name) == nullptr) return false;
+      return (names.empty()
+              || std::find(names.begin(), names.end(), name) != names.end());
+    };
+    auto option = [&] (const optional_argument& o) {
+      if (o.name() == "help" || !selected(o.name())) return;
+      auto sl = lookup(o.name());
+      if (sl->role != 0) return;
+      if (o.nargs() == 0 && !sl->v[0].get<bool>()) return;
+      f(o.options()[0]);
+      if (o.nargs() != 0) for (size_t i=0; i<sl->n; i++) f(sl->v[i].str());
+    };
+
+    /**
+     * The anchors and the scoped options are emitted for each occurrence
+     * in the order of the positions, so that the options are bound to the
+     * same occurrences of the anchors.
+     */
+    std::vector<const abstract_argument*> owner(_slots.size(), nullptr);
+    std::vector<uint8_t> directive(_slots.size(), 0);
+    for (size_t o=0; o<_optional_parsers.size(); o++) {
+      owner[_option_slots[o]] = &_optional_parsers[o];
+      directive[_option_slots[o]] = 1;
+    }
+    for (size_t p=0; p<_positional_parsers.size(); p++)
+      owner[_positional_slots[p]] = &_positional_parsers[p];
+    /** True while the last option takes a variable number of values */
+    bool open(false);
+    auto values = [&] (void) {
+      if (open)
+        throw std::runtime_error("a value follows a variable number of "
+                                 "values of a scoped option.");
+    };
+    auto occurrences = [&] (void) {
+      for (auto& e : _events) {
+        auto& sl = _slots[e.slot];
+        if (!selected(owner[e.slot]->name())) continue;
+        if (sl.role == 2 && !selected(owner[sl.anchor]->name())) continue;
+        if (directive[e.slot]) {
+          auto o = static_cast<const optional_argument*>(owner[e.slot]);
+          f(o->options()[0]);
+          if (o->nargs() != 0)
+            for (size_t i=0; i<e.count; i++) f(_scoped_elements[e.first+i]);
+          open = (o->nargs() < 0);
+        } else {
+          values();
+          f(_scoped_elements[e.first]);
+        }
+      }
+    };
+
+    f(_appname);
+    for (auto& o : _optional_parsers) if (o.nargs()==0) option(o);
+    for (auto& o : _optional_parsers) if (o.nargs()>0) option(o);
+    bool emitted(_events.empty());
+    for (auto& p : _positional_parsers) {
+      if (!selected(p.name())) continue;
+      auto sl = lookup(p.name());
+      if (sl->role != 0 && !emitted) {
+        occurrences();
+        emitted = true;
+        continue;
+      }
+      if (sl->n > 0) values();
+      for (size_t i=0; i<sl->n; i++) f(sl->v[i].str());
+    }
+    for (auto& o : _optional_parsers) if (o.nargs()<0) option(o);
+    if (!emitted) occurrences();
+  }
+
+  void
+  argparse::serialize(argv_buffer& out, const args& names) const
+  {
+    if (!_completed)
+      throw std::runtime_error("arguments are not parsed.");
+
+    /**
+     * The size of the command line is measured at first, so that all
+     * the elements are stored without any reallocation.
+     */
+    size_t nbytes(0), nelem(0);
+    visit_command_line(names, [&] (const arg& s) {
+        nbytes += s.size()+1; nelem++;
+      });
+    out._buffer.resize(nbytes);
+    out._pointers.resize(nelem+1);
+
+    char* p = out._buffer.data();
+    size_t i(0);
+    visit_command_line(names, [&] (const arg& s) {
+        std::memcpy(p, s.c_str(), s.size()+1);
+        out._pointers[i++] = p;
+        p += s.size()+1;
+      });
+    out._pointers[i] = nullptr;
+  }
+
+  void
+  argparse::snapshot(std::vector<char>& out) const
+  {
+    if (!_completed)
+      throw std::runtime_error("arguments are not parsed.");
+    if (!_events.empty())
+      throw std::runtime_error("the occurrences of the scoped options "
+                               "are not stored in a snapshot.");
+
+    size_t nentries(0), nvalues(0), nbytes(0);
+    for (auto& m : _names) {
+      auto& sl = _slots[m.second];
+      if (!sl.found) continue;
+      nbytes += m.first.size()+1;
+      for (size_t i=0; i<sl.n; i++) nbytes += sl.v[i].str().size()+1;
+      nvalues += sl.n;
+      nentries++;
+    }
+    const size_t head = sizeof(snapshot_header)
+      + nentries*sizeof(snapshot_entry) + nvalues*sizeof(uint32_t);
+    if (head+nbytes > std::numeric_limits<uint32_t>::max())
+      throw std::runtime_error("snapshot is too large.");
+    out.assign(head+nbytes, '\0');
+
+    char* base = out.data();
+    auto header = reinterpret_cast<snapshot_header*>(base);
+    auto entry = reinterpret_cast<snapshot_entry*>(header+1);
+    auto offset = reinterpret_cast<uint32_t*>(entry+nentries);
+    std::memcpy(header->magic, "ARGP", 4);
+    header->version = 1;
+    header->size = (uint32_t)out.size();
+    header->nentries = (uint32_t)nentries;
+    header->nvalues = (uint32_t)nvalues;
+
+    size_t p(head), i(0);
+    auto store = [&] (const arg& str) {
+      std::memcpy(base+p, str.c_str(), str.size()+1);
+      p += str.size()+1;
+      return (uint32_t)(p-str.size()-1);
+    };
+    for (auto& m : _names) {
+      auto& sl = _slots[m.second];
+      if (!sl.found) continue;
+      entry->name = store(m.first);
+      entry->type = (uint32_t)sl.type;
+      entry->first = (uint32_t)i;
+      entry->count = (uint32_t)sl.n;
+      for (size_t j=0; j<sl.n; j++) offset[i++] = store(sl.v[j].str());
+      entry++;
+    }
+  }
+
+#ifdef __linux__
+  int
+  argparse::publish(void) const
+  {
+    std::vector<char> buffer;
+    snapshot(buffer);
+
+    int fd = memfd_create("argparse", MFD_ALLOW_SEALING);
+    if (fd < 0)
+      throw std::runtime_error("failed to create a shared memory.");
+    size_t n(0);
+    while (n < buffer.size()) {
+      ssize_t w = write(fd, buffer.data()+n, buffer.size()-n);
+      if (w < 0) {
+        close(fd);
+        throw std::runtime_error("failed to write a shared memory.");
+      }
+      n += w;
+    }
+    const int seals = F_SEAL_SHRINK|F_SEAL_GROW|F_SEAL_WRITE|F_SEAL_SEAL;
+    if (fcntl(fd, F_ADD_SEALS, seals) < 0) {
+      close(fd);
+      throw std::runtime_error("failed to seal a shared memory.");
+    }
+    return fd;
+  }
+#endif
+
+  void
+  argparse::compile_spec(std::vector<char>& out) const
+  {
+    /**
+     * The records are encoded as an array of 32-bit words followed by
+     * NUL-terminated strings, which are referred to by their offsets
+     * from the beginning of the string table. The names are stored in
+     * the order of the map with their slots, so that the map is rebuilt
+     * without any search. The directives are stored only with their
+     * options, from which the tables to match the elements are built.
+     */
+    std::vector<uint32_t> words;
+    std::vector<char> strings;
+    auto store = [&] (const arg& str) {
+      words.push_back((uint32_t)strings.size());
+      strings.insert(strings.end(), str.c_str(), str.c_str()+str.size()+1);
+    };
+
+    for (size_t i=0; i<_optional_parsers.size(); i++) {
+      auto& o = _optional_parsers[i];
+      auto& sl = _slots[_option_slots[i]];
+      store(o.name());
+      store(o.comment());
+      words.push_back((uint32_t)o.type());
+      words.push_back((uint32_t)(int32_t)o.nargs());
+      words.push_back((uint32_t)_option_slots[i]);
+      words.push_back((uint32_t)sl.exits);
+      words.push_back((uint32_t)sl.role);
+      if (sl.role == 2) {
+        words.push_back((uint32_t)sl.scope);
+        words.push_back((uint32_t)sl.anchor);
+      }
+      words.push_back((uint32_t)o.options().size());
+      for (auto& d : o.options()) store(d);
+    }
+    for (size_t i=0; i<_positional_parsers.size(); i++) {
+      auto& a = _positional_parsers[i];
+      store(a.name());
+      store(a.comment());
+      words.push_back((uint32_t)a.type());
+      words.push_back((uint32_t)(int32_t)a.nargs());
+      words.push_back((uint32_t)_positional_slots[i]);
+    }
+    for (auto& m : _names) {
+      auto& sl = _slots[m.second];
+      store(m.first);
+      words.push_back((uint32_t)m.second);
+      words.push_back((uint32_t)sl.defaults.size());
+      for (auto& d : sl.defaults) store(d);
+      words.push_back((uint32_t)sl.choices.size());
+      for (auto& c : sl.choices) store(c);
+    }
+    for (auto& q : _presets) {
+      store(q.directive);
+      store(q.comment);
+      words.push_back((uint32_t)q.elements.size());
+      for (auto& e : q.elements) store(e);
+    }
+    const size_t description = strings.size();
+    strings.insert(strings.end(), _description.c_str(),
+                   _description.c_str()+_description.size()+1);
+
+    const size_t head = sizeof(spec_cache_header)
+      + words.size()*sizeof(uint32_t);
+    if (head+strings.size() > std::numeric_limits<uint32_t>::max())
+      throw std::runtime_error("arguments are too large to be cached.");
+    out.assign(head+strings.size(), '\0');
+    auto header = reinterpret_cast<spec_cache_header*>(out.data());
+    std::memcpy(header->magic, "ARGS", 4);
+    header->version = 4;
+    header->key = 0;
+    header->size = (uint32_t)out.size();
+    header->nwords = (uint32_t)words.size();
+    header->noptions = (uint32_t)_optional_parsers.size();
+    header->npositionals = (uint32_t)_positional_parsers.size();
+    header->nslots = (uint32_t)_slots.size();
+    header->ndirectives = (uint32_t)_dir_offset.size();
+    header->npresets = (uint32_t)_presets.size();
+    header->description = (uint32_t)description;
+    if (!words.empty())
+      std::memcpy(header+1, words.data(), words.size()*sizeof(uint32_t));
+    std::memcpy(out.data()+head, strings.data(), strings.size());
+  }
+
+  bool
+  argparse::restore_spec(const char* data, const size_t size, const arg& key)
+  {
+    auto header = reinterpret_cast<const spec_cache_header*>(data);
+    if (size < sizeof(spec_cache_header)
+        || std::memcmp(header->magic, "ARGS", 4) != 0
+        || header->version != 4 || header->size != size)
+      return false;
+    /** The fingerprint is the hash of the file with the key cleared. */
+    const size_t at = offsetof(spec_cache_header, key);
+    const uint64_t zero(0);
+    uint64_t h = fnv1a(data, at);
+    h = fnv1a(&zero, sizeof(zero), h);
+    h = fnv1a(data+at+sizeof(zero), size-at-sizeof(zero), h);
+    if (header->key != fnv1a(key.data(), key.size(), h)) return false;
+
+    const uint64_t head = sizeof(spec_cache_header)
+      + (uint64_t)header->nwords*sizeof(uint32_t);
+    if (head >= size || data[size-1] != '\0') return false;
+    const uint32_t* w = reinterpret_cast<const uint32_t*>(header+1);
+    const uint32_t* wend = w + header->nwords;
+    const char* strings = data+head;
+    const size_t nstrings = size-head;
+
+    /**
+     * The records are decoded into new containers, which replace the
+     * current ones only if the whole file is valid. Every count is
+     * bounded by the remaining words before the storage is allocated.
+     */
+    std::vector<optional_argument> options;
+    std::vector<positional_argument> positionals;
+    std::vector<size_t> option_slots, positional_slots;
+    std::vector<slot> slots;
+    std::map<arg, size_t> names, preset_index;
+    std::vector<const arg*> directives;
+    std::vector<preset> presets;
+    bool varargs(false);
+    try {
+      auto broken = [] (void) { return std::runtime_error("broken"); };
+      auto word = [&] (void) {
+        if (w == wend) throw broken();
+        return *w++;
+      };
+      auto count = [&] (const uint64_t n, const size_t each) {
+        if (n > (size_t)(wend-w)/each) throw broken();
+        return (size_t)n;
+      };
+      auto text = [&] (void) {
+        const uint32_t p = word();
+        if (p >= nstrings) throw broken();
+        return arg(strings+p);
+      };
+      auto type = [&] (void) {
+        const uint32_t t = word();
+        if (t > (uint32_t)value_type::String) throw broken();
+        return (value_type)t;
+      };
+      auto taken = [this] (const arg& dir) {
+        return _passthrough_nargs.find(dir) != _passthrough_nargs.end()
+#if defined(__unix__) || defined(__APPLE__)
+          || _plugin_index.find(dir) != _plugin_index.end()
+#endif
+          ;
+      };
+      std::vector<uint8_t> typed(count(header->nslots, 4), 0);
+      slots.resize(typed.size());
+      auto assign = [&] (const uint32_t k, const value_type t) {
+        if (k >= slots.size()) throw broken();
+        if (!typed[k]) slots[k].type = t;
+        typed[k] = 1;
+        return (size_t)k;
+      };
+
+      options.reserve(count(header->noptions, 8));
+      option_slots.reserve(options.capacity());
+      for (uint32_t i=0; i<header->noptions; i++) {
+        const arg name = text(), comment = text();
+        const value_type t = type();
+        const int16_t n = (int16_t)(int32_t)word();
+        option_slots.push_back(assign(word(), t));
+        auto& sl = slots[option_slots.back()];
+        sl.exits = (word() != 0);
+        const uint32_t role = word();
+        if (role > 2) throw broken();
+        if (role == 2) {
+          sl.role = 2;
+          const uint32_t scope = word();
+          if (scope > (uint32_t)scope_type::Previous) throw broken();
+          sl.scope = (scope_type)scope;
+          sl.anchor = word();
+        }
+        args dirs(count(word(), 1));
+        for (auto& d : dirs) d = text();
+        options.push_back(optional_argument(dirs, name, t, n, comment));
+      }
+      positionals.reserve(count(header->npositionals, 5));
+      positional_slots.reserve(positionals.capacity());
+      for (uint32_t i=0; i<header->npositionals; i++) {
+        const arg name = text(), comment = text();
+        const value_type t = type();
+        const int16_t n = (int16_t)(int32_t)word();
+        if (n < 0) varargs = true;
+        positional_slots.push_back(assign(word(), t));
+        positionals.push_back(positional_argument(name, t, n, comment));
+      }
+      /** The names are sorted, so that each is inserted at the end. */
+      for (size_t i=0; i<slots.size(); i++) {
+        const arg name = text();
+        const uint32_t k = word();
+        if (k >= slots.size() || typed[k] != 1
+            || (!names.empty() && !(names.rbegin()->first < name)))
+          throw broken();
+        typed[k] = 2;
+        names.emplace_hint(names.end(), name, k);
+        slots[k].defaults.resize(count(word(), 1));
+        for (auto& d : slots[k].defaults) d = text();
+        slots[k].choices.resize(count(word(), 1));
+        for (auto& c : slots[k].choices) c = text();
+      }
+      /** The directives are sorted to find the duplicates. */
+      auto less = [] (const arg* a, const arg* b) { return *a < *b; };
+      for (auto& o : options)
+        for (auto& d : o.options()) {
+          if (taken(d)) throw broken();
+          directives.push_back(&d);
+        }
+      if (directives.size() != header->ndirectives) throw broken();
+      std::sort(directives.begin(), directives.end(), less);
+      for (size_t i=1; i<directives.size(); i++)
+        if (*directives[i-1] == *directives[i]) throw broken();
+      for (auto k : option_slots) {
+        auto& sl = slots[k];
+        if (sl.role != 2) continue;
+        if (sl.anchor >= slots.size() || slots[sl.anchor].role == 2)
+          throw broken();
+        slots[sl.anchor].role = 1;
+      }
+      presets.reserve(count(header->npresets, 3));
+      for (uint32_t i=0; i<header->npresets; i++) {
+        preset q;
+        q.directive = text();
+        q.comment = text();
+        q.elements.resize(count(word(), 1));
+        for (auto& e : q.elements) e = text();
+        if (std::binary_search(directives.begin(), directives.end(),
+                               &q.directive, less)
+            || taken(q.directive)
+            || !preset_index.insert(std::make_pair(q.directive, i)).second)
+          throw broken();
+        presets.push_back(std::move(q));
+      }
+      if (w != wend || header->description >= nstrings)
+        throw broken();
+    } catch (std::runtime_error&) {
+      return false;
+    }
+
+    _optional_parsers.swap(options);
+    _positional_parsers.swap(positionals);
+    _option_slots.swap(option_slots);
+    _positional_slots.swap(positional_slots);
+    _slots.swap(slots);
+    _names.swap(names);
+    _preset_index.swap(preset_index);
+    _presets.swap(presets);
+    _varargs = varargs;
+    _description.assign(strings+header->description);
+    /** The file is the compiled spec, whose hash is the fingerprint. */
+    _fingerprint = h;
+    _fingerprinted = true;
+    compile_index();
+    _completed = false;
+    _tokenized = false;
+    return true;
+  }
+
+  void
+  argparse::save_spec(const arg& path, const arg& key) const
+  {
+    /** The key is derived from the fingerprint and the given text. */
+    std::vector<char> buffer;
+    compile_spec(buffer);
+    const uint64_t h = fnv1a(buffer.data(), buffer.size());
+    reinterpret_cast<spec_cache_header*>(buffer.data())->key
+      = fnv1a(key.data(), key.size(), h);
+
+    /** The cache is written to a temporary file and renamed. */
+    arg temp(path + ".tmp");
+#if defined(__unix__) || defined(__APPLE__)
+    temp += std::to_string((long)getpid());
+#endif
+    FILE* fp = fopen(temp.c_str(), "wb");
+    if (fp == nullptr)
+      throw std::runtime_error("failed to open \"" + temp + "\".");
+    const bool ok = (fwrite(buffer.data(), 1, buffer.size(), fp)
+                     == buffer.size());
+    if (fclose(fp) != 0 || !ok || std::rename(temp.c_str(), path.c_str())) {
+      std::remove(temp.c_str());
+      throw std::runtime_error("failed to write \"" + path + "\".");
+    }
+  }
+
+  bool
+  argparse::load_spec(const arg& path, const arg& key)
+  {
+#if defined(__unix__) || defined(__APPLE__)
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size == 0) {
+      close(fd);
+      return false;
+    }
+    void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return false;
+    bool loaded(false);
+    try {
+      loaded = restore_spec(static_cast<const char*>(p), st.st_size, key);
+    } catch (...) {
+      munmap(p, st.st_size);
+      throw;
+    }
+    munmap(p, st.st_size);
+    return loaded;
+#else
+    FILE* fp = fopen(path.c_str(), "rb");
+    if (fp == nullptr) return false;
+    std::vector<char> buffer;
+    char chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), fp)) > 0)
+      buffer.insert(buffer.end(), chunk, chunk+n);
+    fclose(fp);
+    return restore_spec(buffer.data(), buffer.size(), key);
+#endif
+  }
+
+  uint64_t
+  argparse::fingerprint(void) const
+  {
+    /** The fingerprint is cached until the arguments are modified. */
+    if (_fingerprinted) return _fingerprint;
+    std::vector<char> buffer;
+    compile_spec(buffer);
+    _fingerprint = fnv1a(buffer.data(), buffer.size());
+    _fingerprinted = true;
+    return _fingerprint;
+  }
+
+  void
+  argparse::add_options(const std::vector<option_spec>& specs)
+  {
+    /**
+     * All the definitions are checked before any registration. The hash
+     * sets refer to the strings in `specs` without copying them.
+     */
+    struct hash {
+      size_t operator()(const arg* s) const { return std::hash<arg>()(*s); }
+    };
+    struct equal {
+      bool operator()(const arg* a, const arg* b) const { return *a == *b; }
+    };
+    size_t ndirs(0);
+    for (auto& o : specs) ndirs += o.dirs.size();
+    std::unordered_set<const arg*, hash, equal>
+      dirs(ndirs), names(specs.size());
+    for (auto& o : specs) {
+      if (o.name == "help")
+        throw std::runtime_error("the name \"help\" is predefined.");
+      if (o.dirs.empty())
+        throw std::runtime_error("the option \"" + o.name
+                                 + "\" has no directive.");
+      if (o.nargs == 0 && o.type != value_type::Bool)
+        throw std::runtime_error("the option \"" + o.name
+                                 + "\" takes no element but is not boolean.");
+      if (_names.find(o.name) != _names.end() || !names.insert(&o.name).second)
+        throw std::runtime_error("the name \"" + o.name + "\" is duplicated.");
+      for (auto& d : o.dirs)
+        if (is_defined(d) || !dirs.insert(&d).second)
+          throw std::runtime_error("the directive \"" + d + "\" is defined.");
+    }
+
+    /**
+     * The options are appended to the tables in a single pass. The hash
+     * table is grown once in advance, and the names are merged at last.
+     */
+    size_t nbytes(0), nbuckets(_dir_table.size());
+    for (auto& o : specs) {
+      for (auto& d : o.dirs) nbytes += d.size()+1;
+      nbytes += o.name.size()+1;
+    }
+    while (nbuckets < 2*(_dir_hash.size()+ndirs)) nbuckets *= 2;
+    if (nbuckets != _dir_table.size()) rehash(nbuckets);
+    _strings.reserve(_strings.size()+nbytes);
+    _dir_hash.reserve(_dir_hash.size()+ndirs);
+    _dir_length.reserve(_dir_length.size()+ndirs);
+    _dir_offset.reserve(_dir_offset.size()+ndirs);
+    _dir_option.reserve(_dir_option.size()+ndirs);
+    _opt_nargs.reserve(_opt_nargs.size()+specs.size());
+    _opt_type.reserve(_opt_type.size()+specs.size());
+    _opt_name.reserve(_opt_name.size()+specs.size());
+    _opt_exit.reserve(_opt_exit.size()+specs.size());
+    _optional_parsers.reserve(_optional_parsers.size()+specs.size());
+    _option_slots.reserve(_option_slots.size()+specs.size());
+    _slots.reserve(_slots.size()+specs.size());
+    std::vector<std::pair<const arg*, size_t>> batch;
+    batch.reserve(specs.size());
+    for (auto& o : specs) {
+      slot sl = slot();
+      sl.type = o.type;
+      batch.push_back(std::make_pair(&o.name, _slots.size()));
+      _option_slots.push_back(_slots.size());
+      _slots.push_back(sl);
+      _optional_parsers.push_back(optional_argument(o.dirs, o.name, o.type,
+                                                    o.nargs, o.comment));
+      index_option(_optional_parsers.size()-1);
+    }
+    merge_names(batch);
+    _fingerprinted = false;
+    _completed = false;
+  }
+
+  void
+  argparse::add_arguments(const std::vector<argument_spec>& specs)
+  {
+    std::unordered_set<arg> names(specs.size());
+    bool varargs(_varargs);
+    for (auto& a : specs) {
+      if (a.name == "help")
+        throw std::runtime_error("the name \"help\" is predefined.");
+      if (varargs)
+        throw std::runtime_error("cannot add any argument after varargs.");
+      if (a.nargs == 0 && a.type != value_type::Bool)
+        throw std::runtime_error("the argument \"" + a.name
+                                 + "\" takes no element but is not boolean.");
+      if (_names.find(a.name) != _names.end() || !names.insert(a.name).second)
+        throw std::runtime_error("the name \"" + a.name + "\" is duplicated.");
+      if (a.nargs < 0) varargs = true;
+    }
+    _positional_parsers.reserve(_positional_parsers.size()+specs.size());
+    _positional_slots.reserve(_positional_slots.size()+specs.size());
+    _slots.reserve(_slots.size()+specs.size());
+    std::vector<std::pair<const arg*, size_t>> batch;
+    batch.reserve(specs.size());
+    for (auto& a : specs) {
+      slot sl = slot();
+      sl.type = a.type;
+      batch.push_back(std::make_pair(&a.name, _slots.size()));
+      _positional_slots.push_back(_slots.size());
+      _slots.push_back(sl);
+      _positional_parsers.push_back(positional_argument(a.name, a.type,
+                                                        a.nargs, a.comment));
+    }
+    merge_names(batch);
+    _varargs = varargs;
+    _fingerprinted = false;
+    _completed = false;
+  }
+
+  void
+  argparse::set_default(const arg& name, const args& vals)
+  {
+    auto it = _names.find(name);
+    if (it == _names.end())
+      throw std::runtime_error("the argument \"" + name + "\" is not defined.");
+    for (auto& s : vals) validate(_slots[it->second].type, s.c_str());
+    _slots[it->second].defaults = vals;
+    _fingerprinted = false;
+  }
+
+  void
+  argparse::set_choices(const arg& name, const args& vals)
+  {
+    auto it = _names.find(name);
+    if (it == _names.end())
+      throw std::runtime_error("the argument \"" + name + "\" is not defined.");
+    _slots[it->second].choices = vals;
+    _fingerprinted = false;
+  }
+
+  void
+  argparse::load_schema(std::istream& input)
+  {
+    const arg text((std::istreambuf_iterator<char>(input)),
+                   std::istreambuf_iterator<char>());
+    const json_document doc(text);
+    typedef json_document::kind kind;
+    typedef json_document::node node;
+    const node& root = doc.root();
+    if (root.type != kind::Object)
+      throw std::runtime_error("malformed schema: not an object.");
+
+    auto str = [&] (const node* n, const char* def) {
+      if (n == nullptr) return arg(def);
+      if (n->type != kind::String)
+        throw std::runtime_error("malformed schema: expected a string.");
+      return n->text;
+    };
+    auto list = [&] (const node* n) {
+      args vals;
+      if (n == nullptr) return vals;
+      if (n->type != kind::Array) {
+        vals.push_back(n->text);
+        return vals;
+      }
+      vals.reserve(n->count);
+      for (size_t i=0; i<n->count; i++) vals.push_back(doc.child(*n, i).text);
+      return vals;
+    };
+    auto type = [&] (const node* n) {
+      const arg t = str(n, "bool");
+      if (t == "bool") return value_type::Bool;
+      if (t == "integer") return value_type::Integer;
+      if (t == "float") return value_type::Float;
+      if (t == "string") return value_type::String;
+      throw std::runtime_error("malformed schema: unknown type \"" + t + "\".");
+    };
+    auto nargs = [&] (const node* n, const value_type t) {
+      if (n == nullptr) return (int16_t)((t == value_type::Bool)?0:1);
+      if (n->type != kind::Number)
+        throw std::runtime_error("malformed schema: expected a number.");
+      char* end;
+      errno = 0;
+      const long long v = std::strtoll(n->text.c_str(), &end, 10);
+      if (*end != '\0' || errno == ERANGE
+          || v < std::numeric_limits<int16_t>::min()
+          || v > std::numeric_limits<int16_t>::max())
+        throw std::runtime_error("malformed schema: nargs \"" + n->text
+                                 + "\" is not a 16-bit integer.");
+      return (int16_t)v;
+    };
+    auto exits = [&] (const node* n) {
+      if (n == nullptr) return false;
+      if (n->type != kind::Bool)
+        throw std::runtime_error("malformed schema: expected a boolean.");
+      return n->text == "true";
+    };
+    auto array = [&] (const char* key) {
+      const node* n = doc.member(root, key);
+      if (n != nullptr && n->type != kind::Array)
+        throw std::runtime_error(arg("malformed schema: ")+key
+                                 +" is not an array.");
+      for (size_t i=0; n != nullptr && i<n->count; i++)
+        if (doc.child(*n, i).type != kind::Object)
+          throw std::runtime_error(arg("malformed schema: an element of ")
+                                   +key+" is not an object.");
+      return n;
+    };
+    const node* options = array("options");
+    const node* arguments = array("arguments");
+    const node* presets = array("presets");
+    const size_t no = options?options->count:0;
+    const size_t na = arguments?arguments->count:0;
+
+    /** The storage is reserved for all the arguments at once. */
+    _optional_parsers.reserve(_optional_parsers.size()+no);
+    _option_slots.reserve(_option_slots.size()+no);
+    _positional_parsers.reserve(_positional_parsers.size()+na);
+    _positional_slots.reserve(_positional_slots.size()+na);
+    _slots.reserve(_slots.size()+no+na);
+    if (presets) _presets.reserve(_presets.size()+presets->count);
+
+    if (doc.member(root, "description"))
+      set_description(str(doc.member(root, "description"), ""));
+    auto constrain = [&] (const node& e, const arg& name) {
+      if (doc.member(e, "default"))
+        set_default(name, list(doc.member(e, "default")));
+      if (doc.member(e, "choices"))
+        set_choices(name, list(doc.member(e, "choices")));
+    };
+    for (size_t i=0; i<na; i++) {
+      const node& e = doc.child(*arguments, i);
+      const arg name = str(doc.member(e, "name"), "");
+      const value_type t = type(doc.member(e, "type"));
+      if (name.empty())
+        throw std::runtime_error("malformed schema: an argument needs "
+                                 "a name.");
+      add_argument(name, t, nargs(doc.member(e, "nargs"), t),
+                   str(doc.member(e, "comment"), ""));
+      constrain(e, name);
+    }
+    /**
+     * The positional arguments are registered first and the scoped options
+     * last, so that the anchors are defined before they are referred to.
+     */
+    for (size_t k=0; k<2*no; k++) {
+      const node& e = doc.child(*options, k%no);
+      if ((doc.member(e, "anchor") != nullptr) != (k >= no)) continue;
+      const arg name = str(doc.member(e, "name"), "");
+      const value_type t = type(doc.member(e, "type"));
+      const int16_t n = nargs(doc.member(e, "nargs"), t);
+      const arg comment = str(doc.member(e, "comment"), "");
+      const args dirs = list(doc.member(e, "directives"));
+      if (name.empty() || dirs.empty())
+        throw std::runtime_error("malformed schema: an option needs "
+                                 "a name and directives.");
+      if (doc.member(e, "anchor")) {
+        const arg scope = str(doc.member(e, "scope"), "next");
+        add_scoped_option(dirs, name, t, n,
+                          str(doc.member(e, "anchor"), ""),
+                          (scope == "previous")?
+                          scope_type::Previous:scope_type::Next, comment);
+      } else if (exits(doc.member(e, "exit"))) {
+        add_exit_option(dirs, name, comment);
+      } else {
+        add_option(dirs, name, t, n, comment);
+      }
+      constrain(e, name);
+    }
+    for (size_t i=0; presets && i<presets->count; i++) {
+      const node& e = doc.child(*presets, i);
+      add_preset(str(doc.member(e, "directive"), ""),
+                 list(doc.member(e, "elements")),
+                 str(doc.member(e, "comment"), ""));
+    }
+  }
+
+  void
+  argparse::dump_schema(std::ostream& output) const
+  {
+    auto quote = [&] (const arg& s) {
+      output << '"';
+      for (auto c : s) {
+        if (c == '"' || c == '\\') {
+          output << '\\' << c;
+        } else if (c == '\n') {
+          output << "\\n";
+        } else if ((unsigned char)c < 0x20) {
+          char buf[8];
+          snprintf(buf, sizeof(buf), "\\u%04x", (unsigned)c);
+          output << buf;
+        } else {
+          output << c;
+        }
+      }
+      output << '"';
+    };
+    auto list = [&] (const args& vals) {
+      output << '[';
+      for (size_t i=0; i<vals.size(); i++) {
+        if (i > 0) output << ", ";
+        quote(vals[i]);
+      }
+      output << ']';
+    };
+    auto type = [] (const value_type t) {
+      switch (t) {
+      case value_type::Bool    : return "bool";
+      case value_type::Integer : return "integer";
+      case value_type::Float   : return "float";
+      default                  : return "string";
+      }
+    };
+    std::vector<const arg*> slot_names(_slots.size());
+    for (auto& m : _names) slot_names[m.second] = &m.first;
+    auto common = [&] (const abstract_argument& a, const slot& sl) {
+      output << "\"name\": ";
+      quote(a.name());
+      output << ", \"type\": \"" << type(a.type())
+             << "\", \"nargs\": " << a.nargs() << ", \"comment\": ";
+      quote(a.comment());
+      if (!sl.defaults.empty()) { output << ", \"default\": "; list(sl.defaults); }
+      if (!sl.choices.empty()) { output << ", \"choices\": "; list(sl.choices); }
+    };
+
+    output << "{\n  \"description\": ";
+    quote(_description);
+    output << ",\n  \"options\": [";
+    bool first(true);
+    for (size_t i=0; i<_optional_parsers.size(); i++) {
+      auto& o = _optional_parsers[i];
+      auto& sl = _slots[_option_slots[i]];
+      if (o.name() == "help") continue;
+      output << (first?"\n":",\n") << "    {\"directives\": ";
+      list(o.options());
+      output << ", ";
+      common(o, sl);
+      if (sl.role == 2) {
+        output << ", \"anchor\": ";
+        quote(*slot_names[sl.anchor]);
+        output << ", \"scope\": \""
+               << ((sl.scope == scope_type::Previous)?"previous":"next") << '"';
+      }
+      if (sl.exits) output << ", \"exit\": true";
+      output << '}';
+      first = false;
+    }
+    output << (first?"],\n":"\n  ],\n") << "  \"arguments\": [";
+    first = true;
+    for (size_t i=0; i<_positional_parsers.size(); i++) {
+      output << (first?"\n":",\n") << "    {";
+      common(_positional_parsers[i], _slots[_positional_slots[i]]);
+      output << '}';
+      first = false;
+    }
+    output << (first?"],\n":"\n  ],\n") << "  \"presets\": [";
+    first = true;
+    for (auto& q : _presets) {
+      output << (first?"\n":",\n") << "    {\"directive\": ";
+      quote(q.directive);
+      output << ", \"elements\": ";
+      list(q.elements);
+      output << ", \"comment\": ";
+      quote(q.comment);
+      output << '}';
+      first = false;
+    }
+    output << (first?"]\n}\n":"\n  ]\n}\n");
+  }
+
+  void
+  argparse::generate(std::ostream& output, const arg& ns) const
+  {
+    if (!_presets.empty() || _interpolation)
+      throw std::runtime_error("presets and interpolation are not "
+                               "supported by the generator.");
+    if (_known_args || _response_files)
+      throw std::runtime_error("the parse-known-args mode and response files "
+                               "are not supported by the generator.");
+#if defined(__unix__) || defined(__APPLE__)
+    if (!_plugins.empty())
+      throw std::runtime_error("plugins are not supported by the generator.");
+#endif
+    for (auto& sl : _slots)
+      if (sl.role != 0)
+        throw std::runtime_error("scoped options are not supported "
+                                 "by the generator.");
+
+    /** The members are named after the slots as C++ identifiers. */
+    std::vector<arg> member(_slots.size());
+    std::vector<const arg*> names(_slots.size());
+    std::map<arg, size_t> used{{"exit_option", _slots.size()}};
+    for (auto& m : _names) {
+      names[m.second] = &m.first;
+      arg id;
+      for (auto c : m.first)
+        id += std::isalnum((unsigned char)c)?c:'_';
+      if (id.empty() || std::isdigit((unsigned char)id[0])) id = "_" + id;
+      if (!used.insert(std::make_pair(id, m.second)).second)
+        throw std::runtime_error("the name \"" + m.first
+                                 + "\" clashes with another as an identifier.");
+      member[m.second] = id;
+    }
+    auto quote = [] (const arg& s) {
+      arg q("\"");
+      for (auto c : s) {
+        const unsigned char u = c;
+        if (c == '"' || c == '\\') {
+          q += '\\';
+          q += c;
+        } else if (c == '\n') {
+          q += "\\n\"\n    \"";
+        } else if (u < 0x20 || u >= 0x7f) {
+          char buf[8];
+          snprintf(buf, sizeof(buf), "\\%03o", u);
+          q += buf;
+        } else {
+          q += c;
+        }
+      }
+      return q + "\"";
+    };
+    /** The help message is rendered by the same functions as `show_help` */
+    auto capture = [this] (const bool details) {
+      arg text;
+      FILE* fp = tmpfile();
+      if (fp == nullptr)
+        throw std::runtime_error("failed to create a temporary file.");
+      if (details) explain(fp); else format(fp);
+      std::rewind(fp);
+      char buf[4096];
+      size_t n;
+      while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) text.append(buf, n);
+      fclose(fp);
+      return text;
+    };
+    auto ctype = [] (const value_type t) {
+      switch (t) {
+      case value_type::Bool    : return "bool";
+      case value_type::Integer : return "int64_t";
+      case value_type::Float   : return "double";
+      default                  : return "const char*";
+      }
+    };
+    auto convert = [] (const value_type t) {
+      switch (t) {
+      case value_type::Bool    : return "to_bool";
+      case value_type::Integer : return "to_integer";
+      case value_type::Float   : return "to_float";
+      default                  : return "";
+      }
+    };
+    /**
+     * Emit a statement which stores or validates an element. The first
+     * invalid choice of each slot is reported after all the elements are
+     * converted, in the same order as `parse()`.
+     */
+    auto push = [&] (const size_t k, const arg& s, const char* indent) {
+      auto& sl = _slots[k];
+      output << indent << "if (stored) { (void)" << convert(sl.type)
+             << '(' << s << "); } else {\n";
+      if (!sl.choices.empty()) {
+        output << indent << "  if (!invalid_" << member[k];
+        for (size_t i=0; i<sl.choices.size(); i++)
+          output << " && strcmp(" << s << ", "
+                 << quote(sl.choices[i]) << ") != 0";
+        output << ")\n" << indent << "    invalid_" << member[k] << " = "
+               << s << ";\n";
+      }
+      output << indent << "  r." << member[k] << ".push_back("
+             << convert(sl.type) << '(' << s << "));\n"
+             << indent << "}\n";
+    };
+
+    output << "/** Generated by argparse::argparse::generate(). */\n"
+           << "#include <cctype>\n#include <cerrno>\n#include <cstdint>\n"
+           << "#include <cstdio>\n#include <cstdlib>\n#include <cstring>\n"
+           << "#include <stdexcept>\n#include <string>\n#include <vector>\n\n"
+           << "namespace " << ns << " {\n";
+
+    output << "  /** The parsed values */\n  struct result {\n";
+    for (size_t k=0; k<_slots.size(); k++)
+      output << "    std::vector<" << ctype(_slots[k].type) << "> "
+             << member[k] << ";\n    bool has_" << member[k]
+             << " = false;\n";
+    output << "    /** The name of the option which stopped parsing */\n"
+           << "    std::string exit_option;\n  };\n\n";
+
+    const arg usage = capture(false);
+    output << "  static const char help_head[] =\n    "
+           << quote((_description.size()>0?_description+"\n\n":arg())
+                    + "usage:\n  ") << ";\n"
+           << "  static const char help_usage[] =\n    "
+           << quote(usage.substr(_appname.size()+1)) << ";\n"
+           << "  static const char help_details[] =\n    "
+           << quote(capture(true)) << ";\n\n"
+           << "  /** Display the help message */\n"
+           << "  inline void show_help(FILE* output, const char* app,\n"
+           << "                        const bool simple=false) {\n"
+           << "    fprintf(output, \"%s%s %s%s\", help_head, app, help_usage,\n"
+           << "            simple?\"\":help_details);\n  }\n\n";
+
+    output << "  inline bool to_bool(const char* s) {\n"
+           << "    auto match = [s] (const char* w) {\n"
+           << "      size_t i = 0;\n"
+           << "      for (; w[i] != '\\0'; i++)\n"
+           << "        if (std::tolower((unsigned char)s[i]) != w[i])"
+           << " return false;\n"
+           << "      return s[i] == '\\0';\n    };\n"
+           << "    if (match(\"true\")) return true;\n"
+           << "    if (match(\"false\")) return false;\n"
+           << "    char* e; errno = 0;\n"
+           << "    const long long v = strtoll(s, &e, 10);\n"
+           << "    if (e == s || errno == ERANGE) throw std::runtime_error"
+           << "(\"value is not convertible to boolean-type\");\n"
+           << "    return v != 0;\n  }\n"
+           << "  inline int64_t to_integer(const char* s) {\n"
+           << "    char* e; errno = 0;\n"
+           << "    const long long v = strtoll(s, &e, 10);\n"
+           << "    if (e == s || errno == ERANGE) throw std::runtime_error"
+           << "(\"value is not convertible to integer-type\");\n"
+           << "    return v;\n  }\n"
+           << "  inline double to_float(const char* s) {\n"
+           << "    char* e; errno = 0; const double v = strtod(s, &e);\n"
+           << "    if (e == s || errno == ERANGE) throw std::runtime_error"
+           << "(\"value is not convertible to float-type\");\n"
+           << "    return v;\n  }\n\n";
+
+    /** The directives are matched by their lengths and then by bytes. */
+    std::map<size_t, std::vector<std::pair<arg, size_t>>> by_length;
+    for (size_t i=0; i<_dir_offset.size(); i++)
+      by_length[_dir_length[i]].push_back
+        (std::make_pair(arg(_strings.data()+_dir_offset[i], _dir_length[i]),
+                        (size_t)_dir_option[i]));
+    output << "  /** Return the option of a directive, or -1 */\n"
+           << "  inline int match(const char* s) {\n"
+           << "    switch (strlen(s)) {\n";
+    for (auto& l : by_length) {
+      output << "    case " << l.first << ":\n";
+      for (auto& d : l.second)
+        output << "      if (memcmp(s, " << quote(d.first) << ", "
+               << l.first << ") == 0) return " << d.second << ";\n";
+      output << "      break;\n";
+    }
+    output << "    }\n    return -1;\n  }\n\n";
+
+    output << "  /**\n"
+           << "   * Parse the input arguments and store values.\n"
+           << "   * std::runtime_error is thrown if failed.\n"
+           << "   */\n"
+           << "  inline void parse(const int argc, const char* const* argv,"
+           << " result& r) {\n"
+           << "    std::vector<const char*> rest;\n"
+           << "    rest.reserve(argc);\n";
+    for (size_t k=0; k<_slots.size(); k++)
+      if (!_slots[k].choices.empty())
+        output << "    const char* invalid_" << member[k] << " = nullptr;\n";
+    output
+           << "    int i = 1;\n"
+           << "    while (i < argc) {\n"
+           << "      const char* s = argv[i++];\n"
+           << "      switch (match(s)) {\n";
+    for (size_t o=0; o<_optional_parsers.size(); o++) {
+      const size_t k = _option_slots[o];
+      const int16_t n = _optional_parsers[o].nargs();
+      output << "      case " << o << ": {\n"
+             << "        const bool stored = r.has_" << member[k] << ";\n"
+             << "        r.has_" << member[k] << " = true;\n";
+      if (n == 0) {
+        push(k, "\"true\"", "        ");
+      } else if (n >= 1) {
+        output << "        for (int j=0; j<" << n << "; j++) {\n"
+               << "          if (i >= argc) throw std::runtime_error"
+               << "(\"insufficient number of arguments\");\n"
+               << "          const char* v = argv[i++];\n";
+        push(k, "v", "          ");
+        output << "        }\n";
+      } else {
+        output << "        while (i < argc && match(argv[i]) < 0) {\n"
+               << "          const char* v = argv[i++];\n";
+        push(k, "v", "          ");
+        output << "        }\n";
+      }
+      /** The rest is skipped after an option to stop parsing. */
+      if (_slots[k].exits)
+        output << "        r.exit_option = " << quote(*names[k]) << ";\n"
+               << "        return;\n";
+      output << "        break;\n      }\n";
+    }
+    output << "      default:\n        rest.push_back(s);\n      }\n    }\n";
+
+    /** A missing positional argument with defaults takes them later. */
+    output << "    size_t p = 0;\n";
+    for (size_t a=0; a<_positional_parsers.size(); a++) {
+      const size_t k = _positional_slots[a];
+      const int16_t n = _positional_parsers[a].nargs();
+      if (_slots[k].defaults.empty())
+        output << "    {\n";
+      else
+        output << "    if (p < rest.size() || r.has_" << member[k] << ") {\n";
+      output << "      if (p >= rest.size()) throw std::runtime_error"
+             << "(\"insufficient number of arguments\");\n"
+             << "      const bool stored = r.has_" << member[k] << ";\n"
+             << "      r.has_" << member[k] << " = true;\n";
+      if (n >= 1) {
+        output << "      for (int j=0; j<" << n << "; j++) {\n"
+               << "        if (p >= rest.size()) throw std::runtime_error"
+               << "(\"insufficient number of arguments\");\n"
+               << "        const char* v = rest[p++];\n";
+        push(k, "v", "        ");
+        output << "      }\n";
+      } else if (n == variable_args) {
+        output << "      while (p < rest.size()) {\n"
+               << "        const char* v = rest[p++];\n";
+        push(k, "v", "        ");
+        output << "      }\n";
+      }
+      output << "    }\n";
+    }
+
+    for (size_t k=0; k<_slots.size(); k++) {
+      if (_slots[k].defaults.empty()) continue;
+      output << "    if (!r.has_" << member[k] << ") {\n"
+             << "      const bool stored = false;\n";
+      for (auto& d : _slots[k].defaults) push(k, quote(d), "      ");
+      output << "      r.has_" << member[k] << " = true;\n    }\n";
+    }
+    for (auto& m : _names) {
+      if (_slots[m.second].choices.empty()) continue;
+      const arg& id = member[m.second];
+      output << "    if (invalid_" << id << ")\n"
+             << "      throw std::runtime_error(std::string("
+             << quote("invalid choice \"") << ") + invalid_" << id
+             << " + " << quote("\" for \"" + m.first + "\"") << ");\n";
+    }
+    output << "  }\n}\n";
+  }
+
+  template <class T>
+  const std::vector<T>
+  argparse::getall(const arg& name) const
+  {
+    if (!_completed && !_prescanned)
+      throw std::runtime_error("arguments are not parsed.");
+
+    std::vector<T> retval;
+    auto sl = read(name);
+    if (sl == nullptr)
+      throw std::runtime_error("argument not found.");
+    for (size_t i=0; i<sl->n; i++)
+      retval.push_back(sl->v[i].get<T>());
+    return retval;
+  }
+
+  template <class T>
+  const std::vector<T>
+  argparse::getall(const arg& name, const T& dummy) const
+  {
+    try {
+      return getall<T>(name);
+    } catch (std::exception e) {
+      return std::vector<T>({dummy});
+    }
+  }
+
+  template <class T>
+  const T argparse::get(const arg& name) const
+  {
+    if (!_completed && !_prescanned)
+      throw std::runtime_error("arguments are not parsed.");
+
+    auto sl = read(name);
+    if (sl == nullptr || sl->n == 0)
+      throw std::runtime_error("argument not found.");
+    return sl->v[0].get<T>();
+  }
+
+  template <class T>
+  const T argparse::get(const arg& name, const T& dummy) const
+  {
+    try {
+      return argparse::get<T>(name);
+    } catch (std::runtime_error e) {
+      return dummy;
+    }
+  }
+
+  void
+  argparse::parse(const bool help_on_error,
+                  const bool show_help_and_exit)
+  {
+    auto optsort =
+      [] (const optional_argument &a, const optional_argument &b)
+      { return a.nargs()>b.nargs(); };
+    //std::sort(_op.begin(), _op.end(), optsort);
+    reset();
+    process(help_on_error, show_help_and_exit);
+  }
+
+  void
+  argparse::process(const bool help_on_error,
+                    const bool show_help_and_exit)
+  {
+    auto& _pp = _positional_parsers;
+    /**
+     * `_completed` flag is set `true` when all the conversion is
+     * successfully completed. After that `get()` and `getall()` functions
+     * are enabled. If `show_help_and_exit` is set `true` and `help`
+     * argument is defined, it displays a detailed help message and exits
+     * normally.
+     */
+    auto complete = [&] (void) {
+      _completed = true;
+      if (show_help_and_exit && lookup("help") != nullptr) {
+        show_help(stderr, false);
+        exit(EXIT_SUCCESS);
+      }
+    };
+    try {
+      {
+        /**
+         * At the beginning, all the optional arguments are processed.
+         * When the conversion of an element is failed, it throws
+         * std::runtime_error immediately.
+         */
+        if (!_tokenized) tokenize();
+#if defined(__unix__) || defined(__APPLE__)
+        if (!_plugins.empty()) load_requested_plugins(0);
+#endif
+            if (_counters && _ncounters < _slots.size()) grow_counters();
+        std::vector<const char*>::const_iterator vp = _tokens.begin();
+        while (available(vp)) {
+          ARGPARSE_WORK(1);
+          if (_claimed[vp-_tokens.begin()]) {
+            /** Parsing stops again at the switch given to stop. */
+            if ((size_t)(vp-_tokens.begin()) == _exit_at) break;
+            vp++;
+            continue;
+          }
+          auto d = find_directive(*vp);
+          if (d == npos) {
+            if (_known_args && looks_like_option(*vp)) {
+              /**
+               * In the parse-known-args mode, an unknown option and its
+               * declared values are passed through without any copy.
+               */
+              auto it = _passthrough_nargs.find(_key.assign(*vp));
+              int16_t n = (it == _passthrough_nargs.end())?0:it->second;
+              _passthrough.push_back(*vp); vp++;
+              for (; n>0; n--) {
+                if (!available(vp) || _claimed[vp-_tokens.begin()])
+                  throw std::runtime_error("insufficient number of arguments");
+                _passthrough.push_back(*vp); vp++;
+              }
+            } else {
+              _remaining.push_back(*vp);
+              _remaining_index.push_back(vp-_tokens.begin());
+              vp++;
+            }
+            continue;
+          }
+
+          const size_t at = vp-_tokens.begin();
+          vp++;
+          consume(d, vp);
+          if (_counters) count(_option_slots[d]);
+          if (_opt_exit[d]) {
+            _exit = _optional_parsers[d].name();
+            _exit_at = at;
+            break;
+          }
+        }
+        _passthrough.push_back(nullptr);
+      }
+      /** When a switch to stop is given, the rest is skipped. */
+      if (!_exit.empty()) {
+        complete();
+        return;
+      }
+      {
+        /**
+         * The remaining elements are processed as positional arguments.
+         * When the conversion of an element is failed, it throws
+         * std::runtime_error immediately.
+         */
+        auto vp = _remaining.begin();
+        auto ip = _pp.begin();
+        auto kp = _positional_slots.begin();
+        while (ip != _pp.end()) {
+          if (vp == _remaining.end() && !_slots[*kp].found
+              && !_slots[*kp].defaults.empty()) {
+            /** A missing argument with defaults takes them later. */
+            ip++; kp++;
+            continue;
+          }
+          if (vp == _remaining.end())
+            throw std::runtime_error("insufficient number of arguments");
+
+          const auto& size = ip->nargs();
+          const auto& type = ip->type();
+          const auto& k = *kp;
+          const bool stored = _slots[k].found;
+          /** Each value of a positional anchor is an occurrence. */
+          const bool scoped = (_slots[k].role != 0);
+          auto push = [&] (const char* s) {
+            if (stored) validate(type, s); else store(k, s);
+            if (scoped) {
+              const size_t i = vp-_remaining.begin();
+              _events.push_back(event{k, _remaining_index[i],
+                                      _scoped_elements.size(), 1});
+              _scoped_elements.push_back(s);
+            }
+          };
+          _slots[k].found = true;
+          if (_counters) count(k);
+
+          if (size >= 1) {
+            for (auto i=0; i<size; i++) {
+              if (vp == _remaining.end())
+                throw std::runtime_error("insufficient number of arguments");
+              push(*vp); vp++;
+            }
+          } else if (size == variable_args) {
+            while (vp != _remaining.end()) {
+              push(*vp); vp++;
+            }
+          }
+          ip++; kp++;
+        }
+      }
+      /** The arguments which are not given take their default values. */
+      for (size_t k=0; k<_slots.size(); k++) {
+        auto& sl = _slots[k];
+        if (sl.found || sl.defaults.empty()) continue;
+        for (auto& d : sl.defaults) store(k, d.c_str());
+        sl.found = true;
+      }
+      if (!_events.empty() || !_groups.empty()) bind_scopes();
+      interpolate();
+      for (auto& m : _names) {
+        auto& sl = _slots[m.second];
+        if (!sl.found || sl.choices.empty()) continue;
+        for (size_t i=0; i<sl.n; i++)
+          if (std::find(sl.choices.begin(), sl.choices.end(), sl.v[i].str())
+              == sl.choices.end())
+            throw std::runtime_error("invalid choice \"" + sl.v[i].str()
+                                     + "\" for \"" + m.first + "\"");
+      }
+    } catch (std::runtime_error e) {
+      /**
+       * An unknown option is usually the cause of the error. The options
+       * are reported with suggestions. This is calculated only on failure.
+       */
+      const arg unknown = diagnose_unknown();
+      /**
+       * If `help_on_error` is set `true`, `parse()` function catches any
+       * exception, displays a simplified help message, and exits.
+       */
+      if (help_on_error) {
+        _completed = true; // unlock the `get` function
+        if (lookup("help") != nullptr) {
+          show_help(stderr, false);
+          exit(EXIT_SUCCESS);
+        } else {
+          show_help(stderr, true);
+          fprintf(stderr, "\nerror: %s%s\n", e.what(), unknown.c_str());
+          exit(EXIT_FAILURE);
+        }
+      }
+      if (unknown.size() > 0)
+        throw std::runtime_error(e.what() + unknown);
+      throw;
+    }
+    complete();
+  }
+
+  void
+  argparse::parse(const int nargs, const char** argv,
+                  const bool help_on_error, const bool show_help_and_exit)
+  {
+    _appname = argv[0];
+    _argv0 = argv[0];
+    _arguments = element_range{argv+1, argv+((nargs>1)?nargs:1)};
+    _tokenized = false;
+    parse(help_on_error, show_help_and_exit);
+  }
+
+  /**
+   * @brief A read-only view of a snapshot of parsed values.
+   *
+   * This class provides typed accessors to a snapshot created by
+   * argparse::argparse::snapshot(). The values are read from the snapshot
+   * directly, so that the snapshot should be alive during the lifetime of
+   * the instance.
+   */
+  class snapshot_view {
+  public:
+    /**
+     * @brief Create a view of a snapshot in memory.
+     * @param[in] data The pointer to the snapshot.
+     * @param[in] size The size of the snapshot in bytes.
+     * @exception std::runtime_error is thrown if the snapshot is broken.
+     */
+    snapshot_view(const void* data, const size_t size);
+    snapshot_view(const snapshot_view&) = delete;
+    snapshot_view& operator=(const snapshot_view&) = delete;
+    snapshot_view(snapshot_view&& v)
+      : _data(v._data),_size(v._size),_mapped(v._mapped)
+    { v._mapped = false; }
+    ~snapshot_view(void);
+
+#ifdef __linux__
+    /**
+     * @brief Attach a snapshot published in a shared memory.
+     * @param[in] fd The file descriptor given by `publish()`.
+     * @return A view of the snapshot mapped in read-only mode.
+     * @exception std::runtime_error is thrown if failed.
+     */
+    static snapshot_view attach(const int fd);
+#endif
+
+    /**
+     * @brief Check an argument is defined or not.
+     * @param[in] name The name of the argument in question.
+     */
+    bool find(const arg& name) const
+    { return (lookup(name) != nullptr); }
+
+    /**
+     * @brief Obtain all the values associated with the given name.
+     * @param[in] name The name of the positional or optional argument.
+     * @return An array of the arguments.
+     * @exception std::runtime_error is thrown when the name is not found.
+     */
+    template <class T>
+    const std::vector<T> getall(const arg& name) const;
+
+    /**
+     * @brief Obtain the first value associated with the given name.
+     * @param[in] name The name of the positional or optional argument.
+     * @return The first element of the arguments.
+     * @exception std::runtime_error is thrown when the name is not found.
+     */
+    template <class T>
+    const T get(const arg& name) const;
+
+    /**
+     * @brief Obtain the first value associated with the given name.
+     * @param[in] name The name of the positional or optional argument.
+     * @param[in] dummy A dummy value returned if an argument is not found.
+     * @return The first element of the arguments.
+     */
+    template <class T>
+    const T get(const arg& name, const T& dummy) const;
+  private:
+    const char* _data;  /**< The beginning of the snapshot */
+    size_t _size;       /**< The size of the snapshot */
+    bool _mapped;       /**< True if the snapshot is mapped by `attach` */
+
+    /** Obtain the header of the snapshot */
+    const snapshot_header* header(void) const
+    { return reinterpret_cast<const snapshot_header*>(_data); }
+    /** Find the entry associated with the given name */
+    const snapshot_entry* lookup(const arg& name) const;
+    /** Obtain the i-th value of the entry in the snapshot */
+    const char* at(const snapshot_entry* e, const uint32_t i) const;
+  };
+
+  snapshot_view::snapshot_view(const void* data, const size_t size)
+    : _data(static_cast<const char*>(data)),_size(size),_mapped(false)
+  {
+    if (_size < sizeof(snapshot_header)
+        || std::memcmp(header()->magic, "ARGP", 4) != 0)
+      throw std::runtime_error("not a snapshot of arguments.");
+    if (header()->version != 1)
+      throw std::runtime_error("unsupported snapshot version.");
+    const uint64_t head = sizeof(snapshot_header)
+      + (uint64_t)header()->nentries*sizeof(snapshot_entry)
+      + (uint64_t)header()->nvalues*sizeof(uint32_t);
+    if (header()->size > _size || head > header()->size
+        || (head < header()->size && _data[header()->size-1] != '\0'))
+      throw std::runtime_error("snapshot is broken.");
+    _size = header()->size;
+  }
+
+  snapshot_view::~snapshot_view(void)
+  {
+#ifdef __linux__
+    if (_mapped) munmap(const_cast<char*>(_data), _size);
+#endif
+  }
+
+#ifdef __linux__
+  snapshot_view
+  snapshot_view::attach(const int fd)
+  {
+    struct stat st;
+    if (fstat(fd, &st) < 0)
+      throw std::runtime_error("failed to attach a shared memory.");
+    void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED)
+      throw std::runtime_error("failed to attach a shared memory.");
+    try {
+      snapshot_view view(p, st.st_size);
+      view._mapped = true;
+      view._size = st.st_size;
+      return view;
+    } catch (std::runtime_error& e) {
+      munmap(p, st.st_size);
+      throw;
+    }
+  }
+#endif
+
+  const snapshot_entry*
+  snapshot_view::lookup(const arg& name) const
+  {
+    auto first = reinterpret_cast<const snapshot_entry*>(header()+1);
+    auto last = first + header()->nentries;
+    auto e = std::lower_bound
+      (first, last, name, [&] (const snapshot_entry& e, const arg& n) {
+        return (e.name < _size && n.compare(_data+e.name) > 0);
+      });
+    if (e == last || e->name >= _size || name.compare(_data+e->name) != 0)
+      return nullptr;
+    if ((uint64_t)e->first+e->count > header()->nvalues) return nullptr;
+    return e;
+  }
+
+  const char*
+  snapshot_view::at(const snapshot_entry* e, const uint32_t i) const
+  {
+    auto offset = reinterpret_cast<const uint32_t*>
+      (reinterpret_cast<const snapshot_entry*>(header()+1)
+       + header()->nentries);
+    const uint32_t p = offset[e->first+i];
+    if (p >= _size) throw std::runtime_error("snapshot is broken.");
+    return _data+p;
+  }
+
+#if defined(__unix__) || defined(__APPLE__)
+  void
+  argparse::record(const int fd, const int status)
+  {
+    snapshot(_record);
+    record_header header = record_header();
+    std::memcpy(header.magic, "ARGL", 4);
+    header.version = 2;
+    static const char padding[8] = {};
+    const size_t npad = (8-_record.size()%8)%8;
+    if (sizeof(header)+_record.size()+npad
+        > std::numeric_limits<uint32_t>::max())
+      throw std::runtime_error("record is too large.");
+    header.size = (uint32_t)(sizeof(header)+_record.size()+npad);
+    header.status = status;
+    header.fingerprint = fingerprint();
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    header.timestamp = (int64_t)ts.tv_sec*1000000000 + ts.tv_nsec;
+    header.pid = (int64_t)getpid();
+
+    struct iovec iov[3];
+    iov[0].iov_base = &header;
+    iov[0].iov_len = sizeof(header);
+    iov[1].iov_base = _record.data();
+    iov[1].iov_len = _record.size();
+    iov[2].iov_base = const_cast<char*>(padding);
+    iov[2].iov_len = npad;
+    ssize_t w;
+    do {
+      w = writev(fd, iov, 3);
+    } while (w < 0 && errno == EINTR);
+    if (w != (ssize_t)header.size)
+      throw std::runtime_error("failed to write a record.");
+  }
+
+  void
+  argparse::record(const arg& path, const int status)
+  {
+    int fd = open(path.c_str(), O_WRONLY|O_APPEND|O_CREAT|O_CLOEXEC, 0644);
+    if (fd < 0)
+      throw std::runtime_error("failed to open \"" + path + "\".");
+    try {
+      record(fd, status);
+    } catch (std::runtime_error& e) {
+      close(fd);
+      throw;
+    }
+    close(fd);
+  }
+#endif
+
+  size_t
+  argparse::replay(const void* data, const size_t size)
+  {
+    /** The records are padded, so that an aligned log is read in place. */
+    if (reinterpret_cast<uintptr_t>(data) % alignof(record_header) != 0)
+      throw std::runtime_error("the record is not aligned.");
+    auto header = static_cast<const record_header*>(data);
+    if (size < sizeof(record_header)
+        || std::memcmp(header->magic, "ARGL", 4) != 0
+        || header->version != 2 || header->size > size
+        || header->size < sizeof(record_header) || header->size%8 != 0)
+      throw std::runtime_error("not a record of arguments.");
+    if (header->fingerprint != fingerprint())
+      throw std::runtime_error("the record is made with other arguments.");
+
+    /** The snapshot is checked by the view before it is read. */
+    const char* base = reinterpret_cast<const char*>(header+1);
+    const snapshot_view view(base, header->size-sizeof(record_header));
+    auto sh = reinterpret_cast<const snapshot_header*>(base);
+    const size_t n = sh->size;
+    auto entry = reinterpret_cast<const snapshot_entry*>(sh+1);
+    auto offset = reinterpret_cast<const uint32_t*>(entry+sh->nentries);
+
+    reset();
+    /** The values are stored as they are, since they are substituted. */
+    const bool interpolation = _interpolation;
+    _interpolation = false;
+    try {
+      for (uint32_t i=0; i<sh->nentries; i++, entry++) {
+        if (entry->name >= n || entry->first > sh->nvalues
+            || entry->count > sh->nvalues-entry->first)
+          throw std::runtime_error("snapshot is broken.");
+        auto it = _names.find(arg(base+entry->name));
+        if (it == _names.end())
+          throw std::runtime_error("the record is made with other arguments.");
+        for (uint32_t j=0; j<entry->count; j++) {
+          const uint32_t p = offset[entry->first+j];
+          if (p >= n) throw std::runtime_error("snapshot is broken.");
+          store(it->second, base+p);
+        }
+        _slots[it->second].found = true;
+      }
+    } catch (std::runtime_error& e) {
+      _interpolation = interpolation;
+      reset();
+      throw;
+    }
+    _interpolation = interpolation;
+    _completed = true;
+    return header->size;
+  }
+
+  template <class T>
+  const std::vector<T>
+  snapshot_view::getall(const arg& name) const
+  {
+    auto e = lookup(name);
+    if (e == nullptr)
+      throw std::runtime_error("argument not found.");
+    std::vector<T> retval;
+    for (uint32_t i=0; i<e->count; i++)
+      retval.push_back(value::parse<T>(at(e, i)));
+    return retval;
+  }
+
+  template <class T>
+  const T snapshot_view::get(const arg& name) const
+  {
+    auto e = lookup(name);
+    if (e == nullptr || e->count == 0)
+      throw std::runtime_error("argument not found.");
+    return value::parse<T>(at(e, 0));
+  }
+
+  template <class T>
+  const T snapshot_view::get(const arg& name, const T& dummy) const
+  {
+    try {
+      return get<T>(name);
+    } catch (std::runtime_error& e) {
+      return dummy;
+    }
+  }
+
+  /**
+   * @brief Sources of values merged by argparse::layered_config.
+   * @note The sources are listed in the ascending order of the precedence.
+   */
+  enum class layer_type : uint8_t {
+    None,        /**< No source gives the value */
+    Default,     /**< Default values */
+    File,        /**< Configuration files */
+    Environment, /**< Environment variables */
+    CommandLine  /**< Command-line arguments */
+  };
+
+  /**
+   * @brief A merged view of values given by multiple sources.
+   *
+   * This class holds the values of the arguments defined in a parser for
+   * each `layer_type`, and merges them into a flat view in which the value
+   * of the highest precedence is selected for each argument. Each entry
+   * records the source of the value. The view is updated only for the
+   * arguments whose values are changed.
+   */
+  class layered_config {
+  public:
+    /**
+     * @brief Create an empty view for the arguments of a parser.
+     * @param[in] spec The parser in which the arguments are defined.
+     */
+    layered_config(const argparse& spec);
+
+    /**
+     * @brief Return the index of an argument in the view.
+     * @param[in] name The name of the argument.
+     * @return The index, which is available for the fast accessors.
+     * @exception std::runtime_error is thrown when the name is not found.
+     */
+    size_t index(const arg& name) const;
+
+    /**
+     * @brief Set the values of an argument in a layer.
+     * @param[in] layer The layer of the values.
+     * @param[in] name The name of the argument.
+     * @param[in] vals The values in a form of string.
+     * @exception std::runtime_error is thrown if the conversion is failed,
+     * or if the layer is `layer_type::None`.
+     */
+    void set(const layer_type layer, const arg& name, const args& vals);
+
+    /**
+     * @brief Remove the values of an argument from a layer.
+     * @param[in] layer The layer of the values.
+     * @param[in] name The name of the argument.
+     * @exception std::runtime_error is thrown if the layer is
+     * `layer_type::None`.
+     */
+    void unset(const layer_type layer, const arg& name);
+
+    /**
+     * @brief Replace a layer with the values given by a parser.
+     * @param[in] layer The layer to be replaced.
+     * @param[in] result A parser which has parsed arguments.
+     * @exception std::runtime_error is thrown if the layer is
+     * `layer_type::None`.
+     * @note The arguments which are not defined in the view are ignored.
+     */
+    void load(const layer_type layer, const argparse& result);
+
+    /**
+     * @brief Replace the environment layer with environment variables.
+     * @param[in] prefix The prefix of the environment variables.
+     * @note The variable of an argument is the prefix followed by the name
+     * in upper case, where non-alphanumeric characters are replaced by
+     * underscores. E.g., `APP_LOG_LEVEL` for `log-level` with `APP_`.
+     */
+    void load_environment(const arg& prefix);
+
+    /**
+     * @brief Replace the file layer with a configuration file.
+     * @param[in] input A stream of the configuration file.
+     * @exception std::runtime_error is thrown if a line is malformed or
+     * if the conversion is failed. The layer is not changed in that case.
+     *
+     * @note Each line is `name = value`. Blank lines and lines starting
+     * with `#` are skipped. A name repeated in several lines gives several
+     * values. The arguments which are not defined in the view are ignored.
+     */
+    void load_file(std::istream& input);
+
+    /**
+     * @brief Return the source of the value of an argument.
+     * @param[in] i The index of the argument.
+     */
+    layer_type source(const size_t i) const { return _source[i]; }
+    /**
+     * @brief Return the source of the value of an argument.
+     * @param[in] name The name of the argument.
+     */
+    layer_type source(const arg& name) const { return _source[index(name)]; }
+
+    /**
+     * @brief Check an argument has a value or not.
+     * @param[in] name The name of the argument in question.
+     */
+    bool find(const arg& name) const
+    { auto it = _index.find(name);
+      return (it != _index.end() && _source[it->second] != layer_type::None); }
+
+    /**
+     * @brief Obtain all the values of an argument.
+     * @param[in] i The index of the argument.
+     * @return An array of the values.
+     * @exception std::runtime_error is thrown when no value is given.
+     */
+    template <class T>
+    const std::vector<T> getall(const size_t i) const;
+
+    /**
+     * @brief Obtain the first value of an argument.
+     * @param[in] i The index of the argument.
+     * @return The first value.
+     * @exception std::runtime_error is thrown when no value is given.
+     */
+    template <class T>
+    const T get(const size_t i) const;
+
+    /**
+     * @brief Obtain the first value of an argument.
+     * @param[in] name The name of the argument.
+     * @param[in] dummy A dummy value returned if no value is given.
+     * @return The first value.
+     *
+     * @note The dummy value is also returned if the conversion is failed.
+     */
+    template <class T>
+    const T get(const arg& name, const T& dummy) const;
+  private:
+    static const size_t nlayers = 5;     /**< The number of `layer_type` */
+    std::map<arg, size_t> _index;        /**< The map of (name, index) */
+    std::vector<value_type> _types;      /**< The types of the arguments */
+    std::vector<values> _layers;         /**< The values of each layer */
+    std::vector<layer_type> _source;     /**< The source of each value */
+
+    /** Obtain the values of an argument in a layer */
+    values& at(const size_t i, const layer_type l)
+    { return _layers[i*nlayers+(size_t)l]; }
+    /** Reject a layer which does not hold values */
+    static void writable(const layer_type l)
+    {
+      if (l == layer_type::None || (size_t)l >= nlayers)
+        throw std::runtime_error("invalid layer.");
+    }
+    /** Select the source of an argument */
+    void update(const size_t i);
+    /** Obtain the merged values of an argument */
+    const values& merged(const size_t i) const;
+  };
+
+  layered_config::layered_config(const argparse& spec)
+  {
+    _index = spec._names;
+    for (auto& sl : spec._slots) _types.push_back(sl.type);
+    _layers.resize(_types.size()*nlayers);
+    _source.assign(_types.size(), layer_type::None);
+  }
+
+  size_t
+  layered_config::index(const arg& name) const
+  {
+    auto it = _index.find(name);
+    if (it == _index.end())
+      throw std::runtime_error("argument not found.");
+    return it->second;
+  }
+
+  void
+  layered_config::update(const size_t i)
+  {
+    /** The layer of the highest precedence with values is selected. */
+    _source[i] = layer_type::None;
+    for (size_t l=nlayers; l-- > 1;) {
+      if (!_layers[i*nlayers+l].empty()) {
+        _source[i] = (layer_type)l;
+        break;
+      }
+    }
+  }
+
+  void
+  layered_config::set(const layer_type layer, const arg& name,
+                      const args& vals)
+  {
+    writable(layer);
+    const size_t i = index(name);
+    values v;
+    for (auto& s : vals) v.push_back(value(_types[i], s));
+    at(i, layer).swap(v);
+    update(i);
+  }
+
+  void
+  layered_config::unset(const layer_type layer, const arg& name)
+  {
+    writable(layer);
+    const size_t i = index(name);
+    at(i, layer).clear();
+    update(i);
+  }
+
+  void
+  layered_config::load(const layer_type layer, const argparse& result)
+  {
+    writable(layer);
+    /** Only the arguments given in the old or new layer are updated. */
+    std::vector<uint8_t> given(_types.size(), 0);
+    for (auto& m : result._names) {
+      auto it = _index.find(m.first);
+      auto& sl = result._slots[m.second];
+      if (it == _index.end() || !sl.found) continue;
+      auto& v = at(it->second, layer);
+      v.assign(sl.v.begin(), sl.v.begin()+sl.n);
+      given[it->second] = 1;
+      update(it->second);
+    }
+    for (size_t i=0; i<_types.size(); i++) {
+      if (given[i] || at(i, layer).empty()) continue;
+      at(i, layer).clear();
+      update(i);
+    }
+  }
+
+  void
+  layered_config::load_environment(const arg& prefix)
+  {
+    for (auto& m : _index) {
+      arg var(prefix);
+      for (auto c : m.first)
+        var += std::isalnum((unsigned char)c)?
+          (char)std::toupper((unsigned char)c):'_';
+      const char* env = std::getenv(var.c_str());
+      auto& v = at(m.second, layer_type::Environment);
+      if (env == nullptr) {
+        if (v.empty()) continue;
+        v.clear();
+      } else {
+        v.assign(1, value(_types[m.second], env));
+      }
+      update(m.second);
+    }
+  }
+
+  void
+  layered_config::load_file(std::istream& input)
+  {
+    auto trim = [] (const arg& s, size_t b, size_t e) {
+      while (b < e && std::isspace((unsigned char)s[b])) b++;
+      while (e > b && std::isspace((unsigned char)s[e-1])) e--;
+      return s.substr(b, e-b);
+    };
+    /** All the lines are converted before the layer is replaced. */
+    std::map<size_t, values> layer;
+    arg line;
+    size_t lineno(0);
+    while (std::getline(input, line)) {
+      lineno++;
+      const arg text = trim(line, 0, line.size());
+      if (text.empty() || text[0] == '#') continue;
+      const size_t eq = text.find('=');
+      const arg name = (eq == arg::npos)?arg():trim(text, 0, eq);
+      if (name.empty())
+        throw std::runtime_error("malformed line " + std::to_string(lineno)
+                                 + " in a configuration file.");
+      auto it = _index.find(name);
+      if (it == _index.end()) continue;
+      layer[it->second].push_back(value(_types[it->second],
+                                        trim(text, eq+1, text.size())));
+    }
+    for (size_t i=0; i<_types.size(); i++) {
+      auto it = layer.find(i);
+      auto& v = at(i, layer_type::File);
+      if (it == layer.end()) {
+        if (v.empty()) continue;
+        v.clear();
+      } else {
+        v.swap(it->second);
+      }
+      update(i);
+    }
+  }
+
+  const values&
+  layered_config::merged(const size_t i) const
+  {
+    if (i >= _source.size() || _source[i] == layer_type::None)
+      throw std::runtime_error("argument not found.");
+    return _layers[i*nlayers+(size_t)_source[i]];
+  }
+
+  template <class T>
+  const std::vector<T>
+  layered_config::getall(const size_t i) const
+  {
+    std::vector<T> retval;
+    for (auto& v : merged(i)) retval.push_back(v.get<T>());
+    return retval;
+  }
+
+  template <class T>
+  const T layered_config::get(const size_t i) const
+  {
+    return merged(i)[0].get<T>();
+  }
+
+  template <class T>
+  const T layered_config::get(const arg& name, const T& dummy) const
+  {
+    auto it = _index.find(name);
+    if (it == _index.end() || _source[it->second] == layer_type::None)
+      return dummy;
+    try {
+      return get<T>(it->second);
+    } catch (std::runtime_error& e) {
+      return dummy;
+    }
+  }
+
+  /**
+   * @brief An argument parser without any dynamic allocation.
+   * @tparam MaxArgs The maximum number of the registered arguments.
+   * @tparam MaxTokens The maximum number of the input elements.
+   * @tparam MaxValues The maximum number of the stored values.
+   *
+   * This class provides a subset of argparse::argparse whose state is
+   * stored in fixed-size arrays. The directives, names and elements are
+   * referred to by pointers and never copied, so that they should be alive
+   * during the lifetime of the instance. No exception is thrown; a failed
+   * function returns `false` and the reason is available via `error()`.
+   */
+  template <size_t MaxArgs, size_t MaxTokens, size_t MaxValues>
+  class fixed_argparse {
+  public:
+    fixed_argparse(void)
+      : _nparsers(0),_nvalues(0),_completed(false),
+        _error(nullptr),_element(nullptr) {}
+
+    /**
+     * @brief Add a positional argument.
+     * @param[in] name The name of the argument.
+     * @param[in] type The type of elements.
+     * @param[in] n The number of elements.
+     * @return False if the capacity is exceeded.
+     */
+    bool add_argument(const char* name, const value_type type,
+                      const int16_t n=1)
+    { return add(nullptr, name, type, n); }
+
+    /**
+     * @brief Add an optional argument.
+     * @param[in] dir The directive string of the argument.
+     * @param[in] name The name of the argument.
+     * @param[in] type The type of elements.
+     * @param[in] n The number of elements.
+     * @return False if the capacity is exceeded.
+     */
+    bool add_option(const char* dir, const char* name,
+                    const value_type type=value_type::Bool,
+                    const int16_t n=0)
+    { return add(dir, name, type, n); }
+
+    /**
+     * @brief Parse the input arguments and store values.
+     * @param[in] nargs `nargs` given in the main function.
+     * @param[in] argv `argv` given in the main function.
+     * @return False if failed. The reason is given by `error()`.
+     */
+    bool parse(const int nargs, const char** argv);
+
+    /**
+     * @brief Return the reason of the last failure.
+     * @return A message, or `nullptr` if no error occurred.
+     */
+    const char* error(void) const { return _error; }
+
+    /**
+     * @brief Return the element which caused the last failure.
+     * @return A pointer to the element, or `nullptr` if not available.
+     */
+    const char* error_element(void) const { return _element; }
+
+    /**
+     * @brief Check an argument is defined or not.
+     * @param[in] name The name of the argument in question.
+     */
+    bool find(const char* name) const
+    { auto e = lookup(name); return (e != nullptr && e->found); }
+
+    /**
+     * @brief Return the number of the values associated with a name.
+     * @param[in] name The name of the argument.
+     */
+    size_t count(const char* name) const
+    { auto e = lookup(name); return (e != nullptr)?e->count:0; }
+
+    /**
+     * @brief Obtain a value associated with the given name.
+     * @param[in] name The name of the positional or optional argument.
+     * @param[in] dummy A dummy value returned if an argument is not found.
+     * @param[in] i The index of the value.
+     * @return The i-th element of the arguments.
+     * @note Acceptable types are those of argparse::value::get() except
+     * that `const char*` is used instead of `std::string`.
+     */
+    template <class T>
+    const T get(const char* name, const T& dummy, const size_t i=0) const;
+  private:
+    /** A registered argument */
+    struct entry {
+      const char* dir;    /**< The directive, or `nullptr` if positional */
+      const char* name;   /**< The name of the argument */
+      value_type type;    /**< The type of the values */
+      int16_t nargs;      /**< The number of the values */
+      size_t first;       /**< The index of the first value */
+      size_t count;       /**< The number of the stored values */
+      bool found;         /**< True if the argument is given */
+    };
+    entry _parsers[MaxArgs];             /**< The registered arguments */
+    size_t _nparsers;                    /**< The number of the arguments */
+    const char* _values[MaxValues];      /**< The stored values */
+    size_t _nvalues;                     /**< The number of the values */
+    const char* _remaining[MaxTokens];   /**< The unclaimed elements */
+    bool _completed;                     /**< True if parsed successfully */
+    const char* _error;                  /**< The reason of the failure */
+    const char* _element;                /**< The element of the failure */
+
+    /** Register an argument */
+    bool add(const char* dir, const char* name,
+             const value_type type, const int16_t n);
+    /** Find a registered argument by the name */
+    const entry* lookup(const char* name) const;
+    /** Record a failure and return false */
+    bool fail(const char* msg, const char* element=nullptr)
+    { _error = msg; _element = element; return false; }
+    /**
+     * Append a value to an argument after checking the type. Only the
+     * first occurrence is stored, and the others are checked.
+     */
+    bool push(entry& e, const bool stored, const char* s);
+    /** Check whether an element is convertible to a type */
+    static const char* check(const value_type type, const char* s);
+
+    /** Mark an occurrence, and return true if one is already stored */
+    static bool occur(entry& e)
+    { const bool stored = e.found; e.found = true; return stored; }
+
+    /** Convert an element into an integer */
+    template <class T>
+    static bool convert(const char* s, T& v) {
+      int64_t x;
+      if (!scan_integer(s, x)) return false;
+      v = (T)x;
+      return true;
+    }
+    /** Convert an element into a float */
+    static bool convert(const char* s, double& v)
+    { return scan_float(s, v); }
+    /** Convert an element into a float */
+    static bool convert(const char* s, float& v) {
+      double x;
+      if (!scan_float(s, x)) return false;
+      v = (float)x;
+      return true;
+    }
+    /** Convert an element into a boolean */
+    static bool convert(const char* s, bool& v)
+    { return scan_bool(s, v); }
+    /** Convert an element into a string */
+    static bool convert(const char* s, const char*& v)
+    { v = s; return true; }
+  };
+
+  template <size_t MaxArgs, size_t MaxTokens, size_t MaxValues>
+  bool
+  fixed_argparse<MaxArgs, MaxTokens, MaxValues>::add
+  (const char* dir, const char* name, const value_type type, const int16_t n)
+  {
+    if (_nparsers >= MaxArgs)
+      return fail("too many arguments are registered.", name);
+    _parsers[_nparsers++] = entry{dir, name, type, n, 0, 0, false};
+    _completed = false;
+    return true;
+  }
+
+  template <size_t MaxArgs, size_t MaxTokens, size_t MaxValues>
+  const typename fixed_argparse<MaxArgs, MaxTokens, MaxValues>::entry*
+  fixed_argparse<MaxArgs, MaxTokens, MaxValues>::lookup
+  (const char* name) const
+  {
+    for (size_t i=0; i<_nparsers; i++)
+      if (std::strcmp(_parsers[i].name, name) == 0) return &_parsers[i];
+    return nullptr;
+  }
+
+  template <size_t MaxArgs, size_t MaxTokens, size_t MaxValues>
+  const char*
+  fixed_argparse<MaxArgs, MaxTokens, MaxValues>::check
+  (const value_type type, const char* s)
+  {
+    bool b; int64_t i; double d;
+    switch (type) {
+    case value_type::Bool :
+      return convert(s, b)?nullptr:"value is not convertible to boolean-type";
+    case value_type::Integer :
+      return convert(s, i)?nullptr:"value is not convertible to integer-type";
+    case value_type::Float :
+      return convert(s, d)?nullptr:"value is not convertible to float-type";
+    case value_type::String :
+      return nullptr;
+    default:
+      return "wrong argument type is set.";
+    }
+  }
+
+  template <size_t MaxArgs, size_t MaxTokens, size_t MaxValues>
+  bool
+  fixed_argparse<MaxArgs, MaxTokens, MaxValues>::push
+  (entry& e, const bool stored, const char* s)
+  {
+    auto msg = check(e.type, s);
+    if (msg != nullptr) return fail(msg, s);
+    if (stored) return true;
+    if (_nvalues >= MaxValues) return fail("too many values.", s);
+    if (e.count == 0) e.first = _nvalues;
+    _values[_nvalues++] = s;
+    e.count++;
+    return true;
+  }
+
+  template <size_t MaxArgs, size_t MaxTokens, size_t MaxValues>
+  bool
+  fixed_argparse<MaxArgs, MaxTokens, MaxValues>::parse
+  (const int nargs, const char** argv)
+  {
+    _completed = false;
+    _error = _element = nullptr;
+    _nvalues = 0;
+    for (size_t i=0; i<_nparsers; i++) {
+      _parsers[i].count = 0;
+      _parsers[i].found = false;
+    }
+    if (nargs < 1 || argv == nullptr)
+      return fail("no program name is given.");
+    if ((size_t)(nargs-1) > MaxTokens)
+      return fail("too many elements.");
+
+    auto option = [this] (const char* s) -> entry* {
+      for (size_t i=0; i<_nparsers; i++)
+        if (_parsers[i].dir && std::strcmp(_parsers[i].dir, s) == 0)
+          return &_parsers[i];
+      return nullptr;
+    };
+
+    /** The optional arguments are processed at first. */
+    size_t nremaining(0);
+    int i(1);
+    while (i < nargs) {
+      entry* o = option(argv[i]);
+      if (o == nullptr) {
+        _remaining[nremaining++] = argv[i++];
+        continue;
+      }
+      const bool stored = occur(*o);
+      i++;
+      if (o->nargs == 0) {
+        if (!push(*o, stored, "true")) return false;
+      } else if (o->nargs >= 1) {
+        for (auto j=0; j<o->nargs; j++) {
+          if (i >= nargs)
+            return fail("insufficient number of arguments", o->dir);
+          if (!push(*o, stored, argv[i++])) return false;
+        }
+      } else if (o->nargs == variable_args) {
+        while (i < nargs && option(argv[i]) == nullptr)
+          if (!push(*o, stored, argv[i++])) return false;
+      }
+    }
+
+    /** The remaining elements are processed as positional arguments. */
+    size_t r(0);
+    for (size_t k=0; k<_nparsers; k++) {
+      auto& p = _parsers[k];
+      if (p.dir != nullptr) continue;
+      if (r >= nremaining)
+        return fail("insufficient number of arguments", p.name);
+      const bool stored = occur(p);
+      if (p.nargs >= 1) {
+        for (auto j=0; j<p.nargs; j++) {
+          if (r >= nremaining)
+            return fail("insufficient number of arguments", p.name);
+          if (!push(p, stored, _remaining[r++])) return false;
+        }
+      } else if (p.nargs == variable_args) {
+        while (r < nremaining)
+          if (!push(p, stored, _remaining[r++])) return false;
+      }
+    }
+    _completed = true;
+    return true;
+  }
+
+  template <size_t MaxArgs, size_t MaxTokens, size_t MaxValues>
+  template <class T>
+  const T
+  fixed_argparse<MaxArgs, MaxTokens, MaxValues>::get
+  (const char* name, const T& dummy, const size_t i) const
+  {
+    auto e = lookup(name);
+    if (!_completed || e == nullptr || i >= e->count) return dummy;
+    T v;
+    return convert(_values[e->first+i], v)?v:dummy;
+  }
+
+#if __cplusplus >= 201402L
+  /**
+   * @brief An option known at compile time.
+   *
+   * An array of this structure is used by argparse::static_parse() as the
+   * specification of a command line written as a string literal.
+   */
+  struct static_option {
+    const char* dir;   /**< The directive string of the option */
+    const char* name;  /**< The name of the option */
+    value_type type;   /**< The type of elements */
+    int16_t nargs;     /**< The number of elements (no variable args) */
+  };
+
+  /** A value converted at compile time */
+  struct static_value {
+    int64_t integer;   /**< The value as an integer or a boolean */
+    double real;       /**< The value as a float */
+    const char* text;  /**< The element in the literal (not terminated) */
+    size_t size;       /**< The length of the element */
+  };
+
+  /**
+   * @brief The values of a command line parsed at compile time.
+   * @tparam N The number of the options in the specification.
+   * @tparam MaxValues The maximum number of the stored values.
+   *
+   * All the members are constant expressions when the instance is created
+   * by argparse::static_parse() in a `constexpr` context, so that the
+   * values are stored in the binary as constant data.
+   */
+  template <size_t N, size_t MaxValues>
+  class static_result {
+  public:
+    constexpr static_result(void) {}
+
+    /**
+     * @brief Check an option is given or not.
+     * @param[in] name The name of the option.
+     */
+    constexpr bool find(const char* name) const
+    { return _found[index(name)]; }
+
+    /**
+     * @brief Return the number of the values of an option.
+     * @param[in] name The name of the option.
+     */
+    constexpr size_t count(const char* name) const
+    { return _count[index(name)]; }
+
+    /**
+     * @brief Obtain a value of an option.
+     * @param[in] name The name of the option.
+     * @param[in] i The index of the value.
+     * @exception std::runtime_error is thrown if no value is given.
+     */
+    constexpr const static_value& at(const char* name, size_t i=0) const
+    {
+      const size_t k = index(name);
+      if (i >= _count[k]) throw std::runtime_error("argument not found.");
+      return _values[_first[k]+i];
+    }
+
+    /** Obtain a value of an option as an integer */
+    constexpr int64_t integer(const char* name, size_t i=0) const
+    { return at(name, i).integer; }
+    /** Obtain a value of an option as a boolean */
+    constexpr bool boolean(const char* name, size_t i=0) const
+    { return at(name, i).integer != 0; }
+    /** Obtain a value of an option as a float */
+    constexpr double real(const char* name, size_t i=0) const
+    { return at(name, i).real; }
+
+    /**
+     * @brief Return the elements of the command line.
+     * @return The elements available for argparse::argparse::add_preset().
+     */
+    args elements(void) const
+    {
+      args retval;
+      for (size_t i=0; i<_ntokens; i++)
+        retval.push_back(arg(_tokens[i].text, _tokens[i].size));
+      return retval;
+    }
+
+    template <size_t V, size_t M, size_t L>
+    friend constexpr static_result<M, V>
+    static_parse(const static_option (&spec)[M], const char (&line)[L]);
+  private:
+    const static_option* _spec = nullptr;  /**< The specification */
+    static_value _values[MaxValues] = {};  /**< The stored values */
+    size_t _nvalues = 0;                   /**< The number of the values */
+    static_value _tokens[MaxValues] = {};  /**< The elements */
+    size_t _ntokens = 0;                   /**< The number of the elements */
+    size_t _first[N] = {};                 /**< The first value of options */
+    size_t _count[N] = {};                 /**< The number of the values */
+    bool _found[N] = {};                   /**< True if an option is given */
+
+    /** Find an option by the name */
+    constexpr size_t index(const char* name) const
+    {
+      for (size_t k=0; k<N; k++)
+        if (static_equal(_spec[k].name, name)) return k;
+      throw std::runtime_error("argument not found.");
+    }
+    /** Compare two NUL-terminated strings */
+    static constexpr bool static_equal(const char* a, const char* b)
+    {
+      size_t i = 0;
+      for (; a[i] != '\0' && b[i] != '\0'; i++)
+        if (a[i] != b[i]) return false;
+      return (a[i] == '\0' && b[i] == '\0');
+    }
+    /** Compare a NUL-terminated string with an element of `n` bytes */
+    static constexpr bool static_equal(const char* a, const char* b,
+                                       const size_t n)
+    {
+      size_t i = 0;
+      for (; a[i] != '\0' && i < n; i++)
+        if (a[i] != b[i]) return false;
+      return (a[i] == '\0' && i == n);
+    }
+  };
+
+  /**
+   * @brief An unsigned integer of a fixed width used at compile time.
+   *
+   * This structure holds the exact operands of the conversion of a float,
+   * which needs at most about 3700 bits for a `double`.
+   */
+  struct static_bignum {
+    uint32_t limb[128] = {};  /**< The limbs from the least significant */
+    size_t size = 0;          /**< The number of the used limbs */
+
+    /** Multiply by `m` and add `a` */
+    constexpr void mul_add(const uint32_t m, const uint32_t a)
+    {
+      uint64_t carry = a;
+      for (size_t i=0; i<size; i++) {
+        const uint64_t x = (uint64_t)limb[i]*m + carry;
+        limb[i] = (uint32_t)x;
+        carry = x >> 32;
+      }
+      if (carry == 0) return;
+      if (size >= 128) throw std::runtime_error("value is out of range");
+      limb[size++] = (uint32_t)carry;
+    }
+    /** Multiply by `2^n` */
+    constexpr void shift(const size_t n)
+    {
+      if (size == 0 || n == 0) return;
+      const size_t w = n/32, b = n%32;
+      if (size+w+1 > 128) throw std::runtime_error("value is out of range");
+      limb[size+w] = 0;
+      for (size_t i=size; i-- > 0;) {
+        const uint64_t x = (uint64_t)limb[i] << b;
+        limb[i+w+1] |= (uint32_t)(x >> 32);
+        limb[i+w] = (uint32_t)x;
+      }
+      for (size_t i=0; i<w; i++) limb[i] = 0;
+      size += w+1;
+      while (size > 0 && limb[size-1] == 0) size--;
+    }
+    /** Subtract a number which is not greater */
+    constexpr void subtract(const static_bignum& o)
+    {
+      int64_t borrow = 0;
+      for (size_t i=0; i<size; i++) {
+        const int64_t x = (int64_t)limb[i] - (i<o.size?o.limb[i]:0) - borrow;
+        borrow = (x < 0)?1:0;
+        limb[i] = (uint32_t)(x + (borrow << 32));
+      }
+      while (size > 0 && limb[size-1] == 0) size--;
+    }
+    /** Return -1, 0 or 1 as this is less than, equal to or greater */
+    constexpr int compare(const static_bignum& o) const
+    {
+      if (size != o.size) return (size < o.size)?-1:1;
+      for (size_t i=size; i-- > 0;)
+        if (limb[i] != o.limb[i]) return (limb[i] < o.limb[i])?-1:1;
+      return 0;
+    }
+    /** Return the number of the significant bits */
+    constexpr int bits(void) const
+    {
+      if (size == 0) return 0;
+      int n = 32*(int)(size-1);
+      for (uint32_t x = limb[size-1]; x != 0; x >>= 1) n++;
+      return n;
+    }
+  };
+
+  /**
+   * @brief Round `d * 10^e10 * 2^e2` to the nearest `double`.
+   * @param[in] d The nonzero significand.
+   * @param[in] e10 The decimal exponent.
+   * @param[in] e2 The binary exponent.
+   * @exception std::runtime_error is thrown if the value overflows, or if
+   * the value underflows and is inexact, where `std::strtod` reports
+   * `ERANGE`.
+   *
+   * @note The quotient of the exact operands is calculated bit by bit,
+   * and the ties are rounded to even.
+   */
+  constexpr double
+  static_round(const static_bignum& d, const int e10, const int e2)
+  {
+    static_bignum num = d, den;
+    den.mul_add(0, 1);
+    static_bignum& up = (e10 > 0)?num:den;
+    /** The power of ten is multiplied by up to nine digits at once. */
+    for (int k = (e10 > 0)?e10:-e10; k > 0; k -= 9) {
+      uint32_t p = 1;
+      for (int j=0; j<k && j<9; j++) p *= 10;
+      up.mul_add(p, 0);
+    }
+    if (e2 > 0) num.shift(e2); else den.shift(-e2);
+
+    /** The operands are aligned so that `den <= num < 2*den`. */
+    int e = num.bits() - den.bits();
+    if (e > 0) den.shift(e); else num.shift(-e);
+    if (num.compare(den) < 0) { num.shift(1); e--; }
+    if (e > 1023) throw std::runtime_error("value is out of range");
+    const int bits = (e >= -1022)?53:e+1075;
+    if (bits < 0) throw std::runtime_error("value is out of range");
+
+    /** The significand and a guard bit are followed by a sticky bit. */
+    uint64_t q = 0;
+    for (int j=0; j<=bits; j++) {
+      q <<= 1;
+      if (num.compare(den) >= 0) { num.subtract(den); q |= 1; }
+      num.shift(1);
+    }
+    const bool guard = (q & 1), sticky = (num.size != 0);
+    uint64_t m = q >> 1;
+    if (guard && (sticky || (m & 1))) m++;
+    if (bits < 53 && (guard || sticky))
+      throw std::runtime_error("value is out of range");
+    if (e == 1023 && m == ((uint64_t)1 << 53))
+      throw std::runtime_error("value is out of range");
+
+    /** Every intermediate product is exact. */
+    double v = (double)m;
+    for (int k = e-bits+1; k > 0; k--) v *= 2;
+    for (int k = e-bits+1; k < 0; k++) v /= 2;
+    return v;
+  }
+
+  /**
+   * @brief Compare an element with a lowercase word in any case.
+   * @param[in] s The element.
+   * @param[in] n The length of the element.
+   * @param[in] w The word.
+   */
+  constexpr bool
+  static_word(const char* s, const size_t n, const char* w)
+  {
+    size_t i = 0;
+    for (; w[i] != '\0'; i++) {
+      const char c = (i < n)?s[i]:'\0';
+      if (((c >= 'A' && c <= 'Z')?c-'A'+'a':c) != w[i]) return false;
+    }
+    return (i == n);
+  }
+
+  /**
+   * @brief Convert a whole element into a float as `std::strtod` does.
+   * @param[in] s The element.
+   * @param[in] n The length of the element.
+   * @exception std::runtime_error is thrown if not convertible.
+   *
+   * @note Decimal and hexadecimal floats, infinities and NaNs are
+   * accepted. The value is correctly rounded.
+   */
+  constexpr double
+  static_float(const char* s, const size_t n)
+  {
+    size_t i = 0;
+    const bool negative = (n > 0 && s[0] == '-');
+    if (n > 0 && (s[0] == '-' || s[0] == '+')) i++;
+    const double sign = negative?-1.0:1.0;
+    if (static_word(s+i, n-i, "inf") || static_word(s+i, n-i, "infinity"))
+      return sign*std::numeric_limits<double>::infinity();
+    if (n-i >= 3 && static_word(s+i, 3, "nan")) {
+      bool valid = (n-i == 3);
+      if (n-i >= 5 && s[i+3] == '(' && s[n-1] == ')') {
+        valid = true;
+        for (size_t j=i+4; j+1<n; j++) {
+          const char c = s[j];
+          valid = valid && ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z')
+                            || (c >= 'A' && c <= 'Z') || c == '_');
+        }
+      }
+      if (valid)
+        return negative?-std::numeric_limits<double>::quiet_NaN():
+          std::numeric_limits<double>::quiet_NaN();
+    }
+
+    /**
+     * The significant digits are kept up to the number which determines
+     * the rounding. A nonzero digit dropped afterwards is represented by
+     * an appended digit `1`.
+     */
+    const bool hex = (n-i >= 2 && s[i] == '0' && (s[i+1] | 0x20) == 'x');
+    if (hex) i += 2;
+    const uint32_t base = hex?16:10;
+    const int limit = hex?32:780;
+    static_bignum d;
+    int kept = 0, exponent = 0, digits = 0;
+    bool dropped = false, point = false;
+    for (; i < n; i++) {
+      const char c = s[i];
+      int x = -1;
+      if (c >= '0' && c <= '9') x = c-'0';
+      else if (hex && (c|0x20) >= 'a' && (c|0x20) <= 'f') x = (c|0x20)-'a'+10;
+      else if (c == '.' && !point) { point = true; continue; }
+      else break;
+      digits++;
+      if (kept == 0 && x == 0) {
+        if (point) exponent--;
+        continue;
+      }
+      if (kept < limit) {
+        d.mul_add(base, (uint32_t)x);
+        kept++;
+        if (point) exponent--;
+      } else {
+        dropped = dropped || (x != 0);
+        if (!point) exponent++;
+      }
+    }
+    if (digits == 0) throw std::runtime_error("value is not convertible "
+                                              "to float-type");
+    /** The exponent of a hexadecimal float is binary. */
+    int scale = 0;
+    if (i < n && (s[i]|0x20) == (hex?'p':'e')) {
+      bool minus = false;
+      i++;
+      if (i < n && (s[i] == '-' || s[i] == '+')) minus = (s[i++] == '-');
+      if (i >= n) throw std::runtime_error("value is not convertible "
+                                           "to float-type");
+      for (; i < n && s[i] >= '0' && s[i] <= '9'; i++)
+        if (scale < 100000) scale = scale*10+(s[i]-'0');
+      if (minus) scale = -scale;
+    }
+    if (i != n) throw std::runtime_error("value is not convertible "
+                                         "to float-type");
+    if (kept == 0) return sign*0.0;
+    if (dropped) {
+      d.mul_add(base, 1);
+      kept++;
+      exponent--;
+    }
+
+    /** A value far out of range is rejected before the exact division. */
+    if (hex) {
+      const int top = d.bits()+4*exponent+scale;
+      if (top > 1025 || top < -1075)
+        throw std::runtime_error("value is out of range");
+      return sign*static_round(d, 0, 4*exponent+scale);
+    }
+    exponent += scale;
+    if (kept+exponent > 310 || kept+exponent < -325)
+      throw std::runtime_error("value is out of range");
+    return sign*static_round(d, exponent, 0);
+  }
+
+  /**
+   * @brief Convert an element into a value at compile time.
+   * @param[in] type The type of the element.
+   * @param[in] s The element.
+   * @param[in] n The length of the element.
+   * @exception std::runtime_error is thrown if not convertible, which
+   * fails the build in a `constexpr` context.
+   *
+   * @note A float is converted by argparse::static_float(), which gives
+   * the same value as `scan_float()` for the whole element.
+   */
+  constexpr static_value
+  static_convert(const value_type type, const char* s, const size_t n)
+  {
+    static_value v{0, 0.0, s, n};
+    if (type == value_type::String) return v;
+    if (type == value_type::Float) {
+      v.real = static_float(s, n);
+      /** The integral part is kept if it is representable. */
+      if (v.real > -9.2e18 && v.real < 9.2e18) v.integer = (int64_t)v.real;
+      return v;
+    }
+    if (type == value_type::Bool
+        && (static_word(s, n, "true") || static_word(s, n, "false"))) {
+      v.integer = static_word(s, n, "true")?1:0;
+      v.real = (double)v.integer;
+      return v;
+    }
+    /** The element should be a whole decimal number. */
+    size_t i = 0;
+    const bool negative = (n > 0 && s[0] == '-');
+    if (n > 0 && (s[0] == '-' || s[0] == '+')) i++;
+    size_t digits = 0;
+    int64_t integer = 0;
+    for (; i < n && s[i] >= '0' && s[i] <= '9'; i++, digits++) {
+      if (integer > (std::numeric_limits<int64_t>::max()-9)/10)
+        throw std::runtime_error("value is out of range");
+      integer = integer*10 + (s[i]-'0');
+    }
+    if (digits == 0 || i != n)
+      throw std::runtime_error("value is not convertible to integer-type");
+    v.integer = negative?-integer:integer;
+    v.real = (double)v.integer;
+    return v;
+  }
+
+  /**
+   * @brief Parse a command line written as a string literal.
+   * @tparam MaxValues The maximum number of the elements and the values.
+   * @param[in] spec The array of the options.
+   * @param[in] line The command line. The elements are separated by white
+   * spaces, and an element may be quoted by `"` or `'`.
+   * @return The values of the options.
+   * @exception std::runtime_error is thrown if the command line is wrong,
+   * which fails the build when the result is declared `constexpr`.
+   *
+   * @note The first occurrence of an option is stored and the others are
+   * checked, as argparse::argparse::parse() does. Positional arguments and
+   * variable numbers of elements are not supported.
+   */
+  template <size_t MaxValues, size_t N, size_t L>
+  constexpr static_result<N, MaxValues>
+  static_parse(const static_option (&spec)[N], const char (&line)[L])
+  {
+    static_result<N, MaxValues> r;
+    r._spec = spec;
+    for (size_t k=0; k<N; k++) {
+      if (spec[k].nargs < 0)
+        throw std::runtime_error("variable args are not supported.");
+      for (size_t j=0; j<k; j++)
+        if (static_result<N, MaxValues>::static_equal
+            (spec[j].name, spec[k].name))
+          throw std::runtime_error("a name is duplicated.");
+    }
+
+    /** The literal is split into elements which refer to the literal. */
+    size_t p = 0;
+    while (p+1 < L) {
+      const char c = line[p];
+      if (c == ' ' || c == '\t' || c == '\n') { p++; continue; }
+      if (r._ntokens >= MaxValues)
+        throw std::runtime_error("too many elements.");
+      auto& t = r._tokens[r._ntokens++];
+      if (c == '"' || c == '\'') {
+        size_t e = p+1;
+        while (e+1 < L && line[e] != c) e++;
+        if (e+1 >= L) throw std::runtime_error("unterminated quote.");
+        t.text = line+p+1;
+        t.size = e-p-1;
+        p = e+1;
+      } else {
+        size_t e = p;
+        while (e+1 < L && line[e] != ' ' && line[e] != '\t'
+               && line[e] != '\n') e++;
+        t.text = line+p;
+        t.size = e-p;
+        p = e;
+      }
+    }
+
+    size_t i = 0;
+    while (i < r._ntokens) {
+      const auto& t = r._tokens[i++];
+      size_t k = N;
+      for (size_t j=0; j<N && k==N; j++)
+        if (static_result<N, MaxValues>::static_equal
+            (spec[j].dir, t.text, t.size)) k = j;
+      if (k == N) throw std::runtime_error("unknown option.");
+      const bool stored = r._found[k];
+      if (!stored) {
+        r._found[k] = true;
+        r._first[k] = r._nvalues;
+      }
+      if (spec[k].nargs == 0) {
+        if (!stored) r._values[r._nvalues++] = static_convert
+                       (value_type::Bool, "true", 4);
+      }
+      for (int16_t j=0; j<spec[k].nargs; j++) {
+        if (i >= r._ntokens)
+          throw std::runtime_error("insufficient number of arguments");
+        const auto& e = r._tokens[i++];
+        const auto v = static_convert(spec[k].type, e.text, e.size);
+        if (!stored) r._values[r._nvalues++] = v;
+      }
+      if (!stored) r._count[k] = r._nvalues-r._first[k];
+    }
+    return r;
+  }
+#endif
 }
 
 #endif
@@ -0,0 +1,44 @@
+/***
+ * @brief A minimal checker for the tests
+ *
+ * This code is licensed under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#ifndef __ARGPARSE_TEST_CHECK_H_INCLUDE
+#define __ARGPARSE_TEST_CHECK_H_INCLUDE
+
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+/** The number of the failed checks */
+static int check_failures = 0;
+
+/** Report a failure if the condition is false */
+#define CHECK(cond)                                                     \
+  do {                                                                  \
+    if (!(cond)) {                                                      \
+      fprintf(stderr, "%s:%d: check failed: %s\n",                      \
+              __FILE__, __LINE__, #cond);                               \
+      check_failures++;                                                 \
+    }                                                                   \
+  } while (0)
+
+/** Report a failure unless the statement throws std::runtime_error */
+#define CHECK_THROWS(stmt)                                              \
+  do {                                                                  \
+    bool thrown_ = false;                                               \
+    try { stmt; } catch (std::runtime_error&) { thrown_ = true; }       \
+    if (!thrown_) {                                                     \
+      fprintf(stderr, "%s:%d: not thrown: %s\n",                        \
+              __FILE__, __LINE__, #stmt);                               \
+      check_failures++;                                                 \
+    }                                                                   \
+  } while (0)
+
+/** Return the exit status of a test */
+#define CHECK_RESULT()                                                  \
+  ((check_failures == 0)?EXIT_SUCCESS:EXIT_FAILURE)
+
+#endif
@@ -0,0 +1,78 @@
+/***
+ * @brief A fuzzing harness of argparse::argparse::parse()
+ *
+ * This code is licensed under the MIT License.
+ * https://opensource.org/licenses/MIT
+ *
+ * An input is split into elements at NUL and newline characters. The first
+ * byte selects the modes of the parser. The steps counted by the parser
+ * should be within a budget proportional to the size of the input,
+ * otherwise the harness aborts so that the input is reported as a slow
+ * case. The steps do not depend on the machine or on the sanitizers.
+ */
+
+#define ARGPARSE_COUNT_WORK
+#include "../argparse.h"
+
+/** The budget of the steps: a constant and a cost per byte */
+static const uint64_t budget_base = 4096;
+static const uint64_t budget_per_byte = 8;
+
+extern "C" int
+LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+  if (size == 0) return 0;
+  const uint8_t mode = data[0];
+  std::vector<char> text(data+1, data+size);
+  text.push_back('\0');
+  std::vector<const char*> argv{"fuzz", text.data()};
+  for (size_t i=0; i+1<text.size(); i++) {
+    if (text[i] == '\n') text[i] = '\0';
+    if (text[i] == '\0') argv.push_back(text.data()+i+1);
+  }
+
+  const uint64_t start = argparse::work_counter();
+  try {
+    argparse::argparse parser((int)argv.size(), argv.data(), "fuzz");
+    parser.add_argument("input", argparse::value_type::String, 1, "");
+    parser.add_argument("rest", argparse::value_type::Float,
+                        argparse::variable_args, "");
+    parser.set_default("rest", argparse::args{"0"});
+    parser.add_option(argparse::args{"-n", "--num"}, "num",
+                      argparse::value_type::Integer, 2, "");
+    parser.add_option(argparse::args{"-v", "--values"}, "values",
+                      argparse::value_type::Integer,
+                      argparse::variable_args, "");
+    parser.add_option(argparse::args{"-s", "--string"}, "string",
+                      argparse::value_type::String, 1, "");
+    parser.add_option(argparse::args{"-b"}, "flag", "");
+    parser.add_option(argparse::args{"-f"}, "real",
+                      argparse::value_type::Float, 1, "");
+    parser.add_option(argparse::args{"-c"}, "bool",
+                      argparse::value_type::Bool, 1, "");
+    parser.add_exit_option(argparse::args{"--version"}, "version");
+    parser.add_preset("--fast", argparse::args{"-n", "1", "2", "-b"});
+    parser.add_scoped_option("-r", "rate", argparse::value_type::Integer, 1,
+                             "input", argparse::scope_type::Previous, "");
+    parser.set_known_args(mode & 1);
+    parser.set_interpolation(mode & 2);
+    parser.parse(false, false);
+    parser.getall<std::string>("rest", "");
+    argparse::argv_buffer canonical;
+    parser.serialize(canonical);
+    std::vector<char> snapshot;
+    parser.snapshot(snapshot);
+  } catch (std::runtime_error& e) {
+    if (getenv("FUZZ_VERBOSE")) fprintf(stderr, "error: %s\n", e.what());
+  }
+  const uint64_t steps = argparse::work_counter()-start;
+  if (getenv("FUZZ_VERBOSE"))
+    fprintf(stderr, "%zu bytes in %llu steps\n", size,
+            (unsigned long long)steps);
+  if (steps > budget_base + budget_per_byte*size) {
+    fprintf(stderr, "slow input: %zu bytes in %llu steps\n", size,
+            (unsigned long long)steps);
+    abort();
+  }
+  return 0;
+}
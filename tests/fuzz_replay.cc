@@ -0,0 +1,96 @@
+/***
+ * @brief A driver which replays a corpus through a fuzzing harness
+ *
+ * This code is licensed under the MIT License.
+ * https://opensource.org/licenses/MIT
+ *
+ * Usage: fuzz_parse_replay (file|directory)...
+ *
+ * The long seeds are generated here instead of being stored in the corpus.
+ * They are replayed before the given inputs.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <sys/stat.h>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+/** Generate the long seeds: a mode byte and repeated elements */
+static std::vector<std::vector<uint8_t>>
+generate(void)
+{
+  auto seed = [] (const uint8_t mode, const std::string& head,
+                  const std::string& unit, const int n) {
+    std::string text = head;
+    for (int i=0; i<n; i++) text += unit;
+    std::vector<uint8_t> data{mode};
+    data.insert(data.end(), text.begin(), text.end());
+    return data;
+  };
+  std::vector<std::vector<uint8_t>> seeds;
+  /** A long boolean value */
+  seeds.push_back(seed(0, "a.txt\n-c\n", "t", 200000));
+  /** Many directives and presets */
+  seeds.push_back(seed(0, "a.txt", "\n-b\n-s\nx\n--fast", 5000));
+  /** A chain of the references to the same option */
+  seeds.push_back(seed(2, "a.txt\n-s\n", "${string}", 10000));
+  /** Many unknown options and many values */
+  std::string unknown("a.txt"), values("a.txt\n-v");
+  for (int i=0; i<20000; i++) {
+    unknown += "\n--opt" + std::to_string(i);
+    values += "\n" + std::to_string(i);
+  }
+  seeds.push_back(seed(1, unknown, "", 0));
+  seeds.push_back(seed(0, values, "", 0));
+  return seeds;
+}
+
+static int
+replay(const std::string& path)
+{
+  FILE* fp = fopen(path.c_str(), "rb");
+  if (fp == nullptr) {
+    fprintf(stderr, "error: cannot open %s\n", path.c_str());
+    return 1;
+  }
+  std::vector<uint8_t> data;
+  uint8_t chunk[65536];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), fp)) > 0)
+    data.insert(data.end(), chunk, chunk+n);
+  fclose(fp);
+  LLVMFuzzerTestOneInput(data.data(), data.size());
+  return 0;
+}
+
+int
+main(int argc, char** argv)
+{
+  int failed(0), count(0);
+  for (auto& data : generate()) {
+    LLVMFuzzerTestOneInput(data.data(), data.size());
+    count++;
+  }
+  for (int i=1; i<argc; i++) {
+    struct stat st;
+    if (stat(argv[i], &st) == 0 && S_ISDIR(st.st_mode)) {
+      DIR* dir = opendir(argv[i]);
+      if (dir == nullptr) { failed++; continue; }
+      while (struct dirent* e = readdir(dir)) {
+        if (e->d_name[0] == '.') continue;
+        failed += replay(std::string(argv[i]) + "/" + e->d_name);
+        count++;
+      }
+      closedir(dir);
+    } else {
+      failed += replay(argv[i]);
+      count++;
+    }
+  }
+  printf("%d inputs replayed\n", count);
+  return (failed == 0 && argc > 1) ? 0 : 1;
+}
@@ -0,0 +1,15 @@
+/***
+ * @brief A plugin loaded by the tests of the plugins
+ *
+ * This code is licensed under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#include "../argparse.h"
+
+extern "C" void
+argparse_plugin_init(argparse::argparse& parser)
+{
+  parser.add_option("--foo", "foo", argparse::value_type::Integer);
+  parser.add_option("--bar", "bar");
+}
@@ -0,0 +1,74 @@
+/***
+ * @brief Tests of the bulk registration
+ *
+ * This code is licensed under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#include <string>
+#include "../argparse.h"
+#include "check.h"
+
+int
+main(void)
+{
+  const char* argv[] = {"tool", "-r", "30", "--opt999", "7", "a", "b"};
+  argparse::argparse parser(7, argv, "", false);
+  parser.add_option("-x", "extra", argparse::value_type::Integer);
+  parser.add_preset("--fast", {"-r", "60"});
+  std::vector<argparse::option_spec> options{
+    {{"-r", "--rate"}, "rate", argparse::value_type::Integer, 1, ""},
+    {{"-v"}, "verbose", argparse::value_type::Bool, 0, ""}};
+  for (int i=0; i<1000; i++)
+    options.push_back({{"--opt" + std::to_string(i)}, "opt" + std::to_string(i),
+                       argparse::value_type::Integer, 1, ""});
+  parser.add_options(options);
+  parser.add_arguments({{"files", argparse::value_type::String, -1, ""}});
+
+  /** The names are merged among the registered ones. */
+  for (auto name : {"extra", "rate", "verbose", "opt0", "opt500", "files"})
+    parser.set_default(name, {});
+  CHECK_THROWS(parser.add_options({{{"-o"}, "opt500",
+                                    argparse::value_type::Bool, 0, ""}}));
+
+  /** The registered names and directives are also checked. */
+  CHECK_THROWS(parser.add_options({{{"-x"}, "other",
+                                    argparse::value_type::Integer, 1, ""}}));
+  CHECK_THROWS(parser.add_options({{{"--fast"}, "other",
+                                    argparse::value_type::Integer, 1, ""}}));
+  CHECK_THROWS(parser.add_options({{{"-y"}, "extra",
+                                    argparse::value_type::Integer, 1, ""}}));
+  CHECK_THROWS(parser.add_arguments({{"rate", argparse::value_type::String,
+                                      1, ""}}));
+  CHECK_THROWS(parser.add_options({{{"-a"}, "a", argparse::value_type::Bool,
+                                    0, ""},
+                                   {{"-a"}, "b", argparse::value_type::Bool,
+                                    0, ""}}));
+  /** A non-boolean argument should take elements. */
+  CHECK_THROWS(parser.add_options({{{"-z"}, "zero",
+                                    argparse::value_type::Integer, 0, ""}}));
+  CHECK_THROWS(parser.add_arguments({{"none", argparse::value_type::String,
+                                      0, ""}}));
+
+  parser.parse(false, false);
+  CHECK(parser.get<int>("rate") == 30);
+  CHECK(parser.get<int>("opt999") == 7);
+  CHECK(parser.getall<std::string>("files").size() == 2);
+
+  /** The options added after parsing are matched by the next parse. */
+  std::vector<argparse::option_spec> more;
+  for (int i=0; i<1000; i++)
+    more.push_back({{"--more" + std::to_string(i)}, "more" + std::to_string(i),
+                    argparse::value_type::Integer, 1, ""});
+  parser.add_options(more);
+  parser.add_exit_option(argparse::args{"--version"}, "version");
+  const char* next[] = {"tool", "--more500", "5", "-a", "--opt3", "1",
+                        "--version", "-z"};
+  parser.parse(4, next, false, false);
+  CHECK(parser.get<std::string>("files") == "-a");
+  parser.parse(8, next, false, false);
+  CHECK(parser.get<int>("more500") == 5);
+  CHECK(parser.get<int>("opt3") == 1);
+  CHECK(parser.exit_option() == "version");
+  return CHECK_RESULT();
+}
@@ -0,0 +1,82 @@
+/***
+ * @brief Tests of the options which stop parsing
+ *
+ * This code is licensed under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#include <string>
+#include <vector>
+#include "../argparse.h"
+#include "check.h"
+
+int
+main(void)
+{
+  /** The elements after an exit option are neither expanded nor checked. */
+  const std::string overlong(100, 'x');
+  std::vector<const char*> argv{"tool", "-n", "3", "--version"};
+  for (int i=0; i<100000; i++) argv.push_back("not-a-number");
+  argv.push_back(overlong.c_str());
+  argparse::argparse parser(argv.size(), argv.data(), "", false);
+  parser.add_option("-n", "number", argparse::value_type::Integer);
+  parser.add_option("-s", "string", argparse::value_type::String);
+  parser.add_option("-p", "pair", argparse::value_type::Integer, 2);
+  parser.add_exit_option(argparse::args{"--version"}, "version");
+  parser.add_argument("count", argparse::value_type::Integer);
+  argparse::parse_limits limits;
+  limits.max_token_bytes = 16;
+  parser.set_limits(limits);
+  parser.parse(false, false);
+  CHECK(parser.exit_option() == "version");
+  CHECK(parser.get<int>("number") == 3);
+
+  /** Resuming stops again at the exit option. */
+  const char* again[] = {"tool", "--version", "-n", "x"};
+  parser.parse(4, again, false, false);
+  CHECK(parser.exit_option() == "version");
+  parser.add_option("-m", "more", argparse::value_type::Integer);
+  parser.resume(false, false);
+  CHECK(parser.exit_option() == "version");
+
+  /** An exit option taken as a value does not stop parsing. */
+  std::vector<const char*> value{"tool", "-s", "--version"};
+  for (int i=0; i<100; i++) {
+    value.push_back("-n");
+    value.push_back("4");
+  }
+  value.push_back("1");
+  parser.parse(value.size(), value.data(), false, false);
+  CHECK(parser.exit_option().empty());
+  CHECK(parser.get<std::string>("string") == "--version");
+  CHECK(parser.get<int>("number") == 4);
+  CHECK(parser.get<int>("count") == 1);
+  value.push_back("-n");
+  value.push_back("x");
+  CHECK_THROWS(parser.parse(value.size(), value.data(), false, false));
+
+  /** The values of an option are taken across the expanded chunks. */
+  std::vector<const char*> pair{"tool"};
+  for (int i=0; i<31; i++) {
+    pair.push_back("-n");
+    pair.push_back("5");
+  }
+  pair.push_back("7");
+  pair.push_back("-p");
+  pair.push_back("1");
+  pair.push_back("2");
+  parser.parse(pair.size(), pair.data(), false, false);
+  CHECK(parser.getall<int>("pair").size() == 2);
+  CHECK(parser.getall<int>("pair")[1] == 2);
+  CHECK(parser.get<int>("count") == 7);
+
+  /** The help option also stops parsing before the invalid values. */
+  const char* help[] = {"tool", "-h", "-n", "x"};
+  argparse::argparse helper(4, help);
+  helper.add_option("-n", "number", argparse::value_type::Integer);
+  helper.add_argument("count", argparse::value_type::Integer);
+  helper.parse(false, false);
+  CHECK(helper.exit_option() == "help");
+
+  return CHECK_RESULT();
+}
@@ -0,0 +1,52 @@
+/***
+ * @brief Tests of the parser without dynamic allocation
+ *
+ * This code is licensed under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#include <cstring>
+#include "../argparse.h"
+#include "check.h"
+
+using argparse::value_type;
+
+int
+main(void)
+{
+  argparse::fixed_argparse<8, 16, 16> parser;
+  CHECK(parser.add_argument("arg1", value_type::Integer));
+  CHECK(parser.add_option("-v", "varg", value_type::Integer,
+                          argparse::variable_args));
+  CHECK(parser.add_option("-b", "flag", value_type::Bool, 1));
+  CHECK(parser.add_option("-x", "real", value_type::Float, 1));
+
+  const char* argv[] = {"app", "7", "-b", "TRUE", "-v", "1", "2",
+                        "-x", "2.5", "-b", "0"};
+  CHECK(parser.parse(11, argv));
+  CHECK(parser.get<int32_t>("arg1", 0) == 7);
+  CHECK(parser.count("varg") == 2);
+  CHECK(parser.get<int64_t>("varg", 0, 1) == 2);
+  CHECK(parser.get<double>("real", 0.0) == 2.5);
+  /** Only the first occurrence is stored. */
+  CHECK(parser.count("flag") == 1);
+  CHECK(parser.get<bool>("flag", false));
+
+  const char* bad[] = {"app", "7", "-b", "maybe"};
+  CHECK(!parser.parse(4, bad));
+  CHECK(std::strcmp(parser.error(),
+                    "value is not convertible to boolean-type") == 0);
+  CHECK(std::strcmp(parser.error_element(), "maybe") == 0);
+
+  const char* insufficient[] = {"app", "-x"};
+  CHECK(!parser.parse(2, insufficient));
+
+  /** A missing program name is distinguished from too many elements. */
+  CHECK(!parser.parse(0, argv));
+  CHECK(std::strcmp(parser.error(), "no program name is given.") == 0);
+  const char* many[18] = {"app"};
+  for (int i=1; i<18; i++) many[i] = "1";
+  CHECK(!parser.parse(18, many));
+  CHECK(std::strcmp(parser.error(), "too many elements.") == 0);
+  return CHECK_RESULT();
+}
@@ -0,0 +1,101 @@
+/***
+ * @brief A differential test of the generated parser against `parse()`
+ *
+ * This code is licensed under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#include <fstream>
+#include <random>
+#include <string>
+#include "../argparse.h"
+#include "generated_cli.h"
+#include "check.h"
+
+/** Compare the values of an argument stored by both parsers */
+template <class T, class U>
+static bool
+same(const argparse::argparse& p, const char* name, const bool has,
+     const std::vector<U>& v)
+{
+  if (p.find(name) != has) return false;
+  if (!has) return true;
+  auto a = p.getall<T>(name);
+  if (a.size() != v.size()) return false;
+  for (size_t i=0; i<a.size(); i++)
+    if (a[i] != T(v[i])) return false;
+  return true;
+}
+
+/** Parse a command line by both parsers and compare the results */
+static void
+compare(std::vector<const char*> line)
+{
+  argparse::argparse p((int)line.size(), line.data(), "", true);
+  std::ifstream schema(ARGPARSE_TEST_SCHEMA);
+  p.load_schema(schema);
+
+  std::string e1, e2;
+  bool ok1(false), ok2(false);
+  try { p.parse(false, false); ok1 = true; }
+  catch (std::runtime_error& e) { e1 = e.what(); }
+  cli::result r;
+  try { cli::parse((int)line.size(), line.data(), r); ok2 = true; }
+  catch (std::runtime_error& e) { e2 = e.what(); }
+
+  bool agreed = (ok1 == ok2);
+  if (agreed && !ok1) {
+    /** `parse()` may append suggestions for unknown options. */
+    agreed = (e1.compare(0, e2.size(), e2) == 0);
+  } else if (agreed) {
+    agreed = p.exit_option() == r.exit_option
+      && same<int64_t>(p, "num", r.has_num, r.num)
+      && same<int64_t>(p, "values", r.has_values, r.values)
+      && same<std::string>(p, "string", r.has_string, r.string)
+      && same<bool>(p, "flag", r.has_flag, r.flag)
+      && same<double>(p, "ratio", r.has_ratio, r.ratio)
+      && same<bool>(p, "check", r.has_check, r.check)
+      && same<bool>(p, "help", r.has_help, r.help)
+      && same<std::string>(p, "input", r.has_input, r.input)
+      && same<double>(p, "rest", r.has_rest, r.rest);
+  }
+  if (!agreed) {
+    fprintf(stderr, "differ:");
+    for (size_t i=1; i<line.size(); i++) fprintf(stderr, " '%s'", line[i]);
+    fprintf(stderr, "\n  parse(): %s\n  generated: %s\n",
+            ok1?"ok":e1.c_str(), ok2?"ok":e2.c_str());
+    check_failures++;
+  }
+}
+
+int
+main(void)
+{
+  /** The command lines are drawn from the directives and some values. */
+  const char* pool[] = {"-n", "--num", "-v", "--values", "-s", "--string",
+                        "-b", "-f", "-c", "--version", "-h", "--help",
+                        "1", "-3", "42", "x", "a", "b", "d", "1.5", "-0.5",
+                        "true", "False", "0", "12abc", "1e3", "", "-x",
+                        "--", "99999999999999999999",
+                        "4294967296", "-9223372036854775808"};
+  const size_t npool = sizeof(pool)/sizeof(pool[0]);
+  std::mt19937 rng(20261018);
+  for (int t=0; t<5000; t++) {
+    std::vector<const char*> line{"app"};
+    const size_t n = rng() % 9;
+    for (size_t i=0; i<n; i++) line.push_back(pool[rng() % npool]);
+    compare(line);
+    if (check_failures > 20) break;
+  }
+
+  /** The exit options skip the missing positional arguments. */
+  cli::result r;
+  const char* help[] = {"app", "-n", "1", "2", "-h", "-n"};
+  cli::parse(6, help, r);
+  CHECK(r.exit_option == "help" && r.num.size() == 2);
+  const char* version[] = {"app", "--version"};
+  cli::result v;
+  cli::parse(2, version, v);
+  CHECK(v.exit_option == "version" && !v.has_input);
+  return CHECK_RESULT();
+}
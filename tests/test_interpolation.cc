@@ -0,0 +1,49 @@
+/***
+ * @brief Tests of the interpolation of the values
+ *
+ * This code is licensed under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#include "../argparse.h"
+#include "check.h"
+
+int
+main(void)
+{
+  const char* argv[] = {"tool", "--base", "/opt", "--dir", "${base}/bin",
+                        "--lib", "${dir}/../lib"};
+  argparse::argparse parser(7, argv, "", false);
+  parser.set_interpolation(true);
+  parser.add_option("--base", "base", argparse::value_type::String);
+  parser.add_option("--dir", "dir", argparse::value_type::String);
+
+  /** The prescanned values are substituted before they are read. */
+  parser.prescan(argparse::args{"base", "dir"});
+  CHECK(parser.get<std::string>("dir") == "/opt/bin");
+  parser.add_option("--lib", "lib", argparse::value_type::String);
+  parser.resume(false, false);
+  CHECK(parser.get<std::string>("dir") == "/opt/bin");
+  CHECK(parser.get<std::string>("lib") == "/opt/bin/../lib");
+
+  /** A failed substitution leaves no placeholder in the buffers. */
+  const char* bad[] = {"tool", "-n", "${ARGPARSE_TEST_UNDEFINED}"};
+  const char* word[] = {"tool", "-n", "abc"};
+  const char* num[] = {"tool", "-n", "42"};
+  argparse::argparse p2(3, bad, "", false);
+  p2.set_interpolation(true);
+  p2.add_option("-n", "num", argparse::value_type::Integer);
+  CHECK_THROWS(p2.parse(false, false));
+  CHECK_THROWS(p2.parse(3, word, false, false));
+  p2.parse(3, num, false, false);
+  CHECK(p2.get<int32_t>("num") == 42);
+
+  /** The circular references are rejected. */
+  const char* loop[] = {"tool", "-a", "${b}", "-b", "${a}"};
+  argparse::argparse p3(5, loop, "", false);
+  p3.set_interpolation(true);
+  p3.add_option("-a", "a", argparse::value_type::String);
+  p3.add_option("-b", "b", argparse::value_type::String);
+  CHECK_THROWS(p3.parse(false, false));
+  return CHECK_RESULT();
+}
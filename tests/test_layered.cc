@@ -0,0 +1,66 @@
+/***
+ * @brief Tests of the layered configuration
+ *
+ * This code is licensed under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#include <sstream>
+#include "../argparse.h"
+#include "check.h"
+
+int
+main(void)
+{
+  const char* argv[] = {"tool", "-j", "16"};
+  argparse::argparse parser(3, argv, "", false);
+  parser.add_option("-j", "threads", argparse::value_type::Integer);
+  parser.add_option("-I", "include", argparse::value_type::String);
+  parser.add_option("-l", "level", argparse::value_type::String);
+  parser.parse(false, false);
+
+  argparse::layered_config cfg(parser);
+  cfg.set(argparse::layer_type::Default, "threads", {"4"});
+  cfg.set(argparse::layer_type::Default, "include", {"/usr/include"});
+  std::istringstream file("# paths\n"
+                          "include = /opt/include\n"
+                          "  include=/srv/include  \n"
+                          "\n"
+                          "unknown = 1\n"
+                          "threads = 6\n"
+                          "level = high\n");
+  cfg.load_file(file);
+  CHECK(cfg.source("include") == argparse::layer_type::File);
+  auto inc = cfg.getall<std::string>(cfg.index("include"));
+  CHECK(inc.size() == 2 && inc[0] == "/opt/include"
+        && inc[1] == "/srv/include");
+  CHECK(cfg.get<int>(cfg.index("threads")) == 6);
+
+  /** The command line overrides the file. */
+  cfg.load(argparse::layer_type::CommandLine, parser);
+  CHECK(cfg.source("threads") == argparse::layer_type::CommandLine);
+  CHECK(cfg.get<int>(cfg.index("threads")) == 16);
+
+  /** A failed conversion or a missing argument gives the dummy. */
+  CHECK(cfg.get<int>("level", 3) == 3);
+  CHECK(cfg.get<int>("missing", 7) == 7);
+
+  /** A malformed or inconvertible file leaves the layer unchanged. */
+  std::istringstream malformed("include\n");
+  CHECK_THROWS(cfg.load_file(malformed));
+  std::istringstream wrong("threads = many\n");
+  CHECK_THROWS(cfg.load_file(wrong));
+  CHECK(cfg.source("include") == argparse::layer_type::File);
+
+  /** An empty file clears the layer. */
+  std::istringstream empty("");
+  cfg.load_file(empty);
+  CHECK(cfg.source("include") == argparse::layer_type::Default);
+
+  /** No values are written into the layer `None`. */
+  CHECK_THROWS(cfg.set(argparse::layer_type::None, "threads", {"2"}));
+  CHECK_THROWS(cfg.unset(argparse::layer_type::None, "threads"));
+  CHECK_THROWS(cfg.load(argparse::layer_type::None, parser));
+  CHECK(cfg.get<int>(cfg.index("threads")) == 16);
+  return CHECK_RESULT();
+}
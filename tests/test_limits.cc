@@ -0,0 +1,100 @@
+/***
+ * @brief Tests of the budgets for untrusted command lines
+ *
+ * This code is licensed under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "../argparse.h"
+#include "check.h"
+
+/** The directory of the response files */
+static std::string directory;
+
+/** Write a response file and return the element referring to it */
+static std::string
+write(const std::string& name, const std::string& text)
+{
+  const std::string path = directory + "/" + name;
+  FILE* fp = fopen(path.c_str(), "w");
+  fputs(text.c_str(), fp);
+  fclose(fp);
+  return "@" + path;
+}
+
+/** Parse a command line with the budgets */
+static void
+parse(argparse::argparse& parser, const argparse::parse_limits& limits,
+      const std::vector<std::string>& line)
+{
+  std::vector<const char*> argv{"tool"};
+  for (auto& e : line) argv.push_back(e.c_str());
+  parser.set_limits(limits);
+  parser.parse(argv.size(), argv.data(), false, false);
+}
+
+int
+main(void)
+{
+  char temp[] = "/tmp/argparse_limitsXXXXXX";
+  CHECK(mkdtemp(temp) != nullptr);
+  directory = temp;
+  const char* argv[] = {"tool"};
+  argparse::argparse parser(1, argv, "", false);
+  parser.add_option("-v", "values", argparse::value_type::String, -1);
+  parser.add_argument("files", argparse::value_type::String, -1);
+  parser.set_response_files(true);
+
+  /** Every element of the command line counts, even an empty file. */
+  const std::string empty = write("empty.rsp", "");
+  argparse::parse_limits tokens;
+  tokens.max_tokens = 2;
+  parse(parser, tokens, {"a", "b"});
+  CHECK_THROWS(parse(parser, tokens, {"a", "b", "c"}));
+  CHECK_THROWS(parse(parser, tokens, {"a", empty, "c"}));
+  CHECK_THROWS(parse(parser, tokens, {write("three.rsp", "a b c")}));
+
+  /** A file loaded shallower is still checked where it is spliced. */
+  const std::string c = write("c.rsp", "z");
+  const std::string b = write("b.rsp", c);
+  const std::string a = write("a.rsp", b);
+  argparse::parse_limits depth;
+  depth.max_depth = 2;
+  parse(parser, depth, {c});
+  parse(parser, depth, {b});
+  CHECK_THROWS(parse(parser, depth, {a}));
+  CHECK_THROWS(parse(parser, depth, {c, a}));
+
+  /** The files share the budget of bytes. */
+  const std::string x = write("x.rsp", "12345 ");
+  const std::string y = write("y.rsp", "67890 ");
+  argparse::parse_limits bytes;
+  bytes.max_response_bytes = 10;
+  parse(parser, bytes, {x, x});
+  CHECK_THROWS(parse(parser, bytes, {x, y}));
+  /** The budget is derived from the number and the length otherwise. */
+  argparse::parse_limits derived;
+  derived.max_tokens = 2;
+  derived.max_token_bytes = 2;
+  CHECK_THROWS(parse(parser, derived, {x}));
+
+  /** The elements and the values are checked. */
+  argparse::parse_limits element;
+  element.max_token_bytes = 4;
+  CHECK_THROWS(parse(parser, element, {"12345"}));
+  argparse::parse_limits values;
+  values.max_values = 2;
+  parse(parser, values, {"f", "-v", "1", "2"});
+  CHECK_THROWS(parse(parser, values, {"f", "-v", "1", "2", "3"}));
+  argparse::parse_limits total;
+  total.max_value_bytes = 8;
+  CHECK_THROWS(parse(parser, total, {"1234", "5678"}));
+
+  std::string command = "rm -rf " + directory;
+  CHECK(system(command.c_str()) == 0);
+  return CHECK_RESULT();
+}
@@ -0,0 +1,48 @@
+/***
+ * @brief Tests of the parse-known-args mode
+ *
+ * This code is licensed under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#include <cstring>
+#include <utility>
+#include "../argparse.h"
+#include "check.h"
+
+int
+main(void)
+{
+  const char* argv[] = {"tool", "--unknown", "file.txt", "--level", "3",
+                        "-v", "--opt=x"};
+  argparse::argparse parser(7, argv, "", false);
+  parser.add_argument("file", argparse::value_type::String);
+  parser.add_option("-v", "verbose");
+  parser.add_passthrough("--level", 1);
+  parser.set_known_args(true);
+  parser.parse(false, false);
+
+  /** The values are passed only when declared. */
+  CHECK(parser.get<std::string>("file") == "file.txt");
+  CHECK(parser.find("verbose"));
+  auto& child = parser.passthrough();
+  CHECK(child.size() == 6);
+  CHECK(child[0] == argv[0]);
+  CHECK(child[1] == argv[1]);
+  CHECK(child[2] == argv[3] && child[3] == argv[4]);
+  CHECK(child[4] == argv[6]);
+  CHECK(child[5] == nullptr);
+
+  /** The pointers refer to `argv` even after the parser is moved. */
+  argparse::argparse moved(std::move(parser));
+  CHECK(moved.passthrough()[0] == argv[0]);
+
+  const char* missing[] = {"tool", "file.txt", "--level"};
+  argparse::argparse p2(3, missing, "", false);
+  p2.add_argument("file", argparse::value_type::String);
+  p2.add_passthrough("--level", 1);
+  p2.set_known_args(true);
+  CHECK_THROWS(p2.parse(false, false));
+  CHECK_THROWS(p2.add_passthrough("--level", -1));
+  return CHECK_RESULT();
+}
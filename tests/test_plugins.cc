@@ -0,0 +1,69 @@
+/***
+ * @brief Tests of the plugins
+ *
+ * This code is licensed under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "../argparse.h"
+#include "check.h"
+
+int
+main(void)
+{
+  /** A plugin is loaded by its directive and registers it. */
+  const char* argv[] = {"tool", "--foo", "3", "f.txt"};
+  argparse::argparse parser(4, argv, "", false);
+  parser.add_argument("file", argparse::value_type::String);
+  parser.add_plugin(ARGPARSE_TEST_PLUGIN, argparse::args{"--foo", "--bar"});
+  CHECK_THROWS(parser.add_option("--foo", "other",
+                                 argparse::value_type::Integer));
+  parser.parse(false, false);
+  CHECK(parser.get<int>("foo") == 3);
+  CHECK(!parser.find("bar"));
+  const char* next[] = {"tool", "--bar", "g.txt"};
+  parser.parse(3, next, false, false);
+  CHECK(parser.find("bar"));
+
+  /** A plugin is loaded while the values of an option are expanded. */
+  std::vector<std::string> values;
+  for (int i=0; i<100; i++) values.push_back(std::to_string(i));
+  std::vector<const char*> line{"tool", "h.txt", "-m"};
+  for (auto& v : values) line.push_back(v.c_str());
+  line.push_back("--foo");
+  line.push_back("5");
+  argparse::argparse chunked(1, argv, "", false);
+  chunked.add_argument("file", argparse::value_type::String);
+  chunked.add_option("-m", "many", argparse::value_type::Integer, 100);
+  chunked.add_plugin(ARGPARSE_TEST_PLUGIN, argparse::args{"--foo", "--bar"});
+  chunked.parse(line.size(), line.data(), false, false);
+  CHECK(chunked.getall<int>("many").size() == 100);
+  CHECK(chunked.getall<int>("many")[99] == 99);
+  CHECK(chunked.get<int>("foo") == 5);
+
+  /** All the plugins are loaded for the help message. */
+  const char* help[] = {"tool", "-h"};
+  argparse::argparse helper(2, help);
+  helper.add_plugin(ARGPARSE_TEST_PLUGIN, argparse::args{"--foo", "--bar"});
+  helper.parse(false, false);
+  CHECK(helper.exit_option() == "help");
+  FILE* fp = tmpfile();
+  helper.show_help(fp);
+  std::string text(4096, '\0');
+  rewind(fp);
+  text.resize(fread(&text[0], 1, text.size(), fp));
+  fclose(fp);
+  CHECK(text.find("--foo") != std::string::npos);
+  CHECK(text.find("--bar") != std::string::npos);
+
+  /** A missing plugin is an error. */
+  const char* missing[] = {"tool", "--baz"};
+  argparse::argparse broken(2, missing, "", false);
+  broken.add_plugin("/nonexistent/plugin.so", argparse::args{"--baz"});
+  CHECK_THROWS(broken.parse(false, false));
+
+  return CHECK_RESULT();
+}
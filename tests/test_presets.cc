@@ -0,0 +1,55 @@
+/***
+ * @brief Tests of the presets
+ *
+ * This code is licensed under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#include "../argparse.h"
+#include "check.h"
+
+int
+main(void)
+{
+  const char* argv[] = {"tool", "--fast", "file.txt"};
+  argparse::argparse parser(3, argv, "", false);
+  parser.add_argument("file", argparse::value_type::String);
+  parser.add_option("-j", "jobs", argparse::value_type::Integer, 1);
+  parser.add_option("-O", "optimize");
+  parser.add_preset("--quick", {"-O"});
+  parser.add_preset("--fast", {"--quick", "-j", "8"});
+
+  /** The directives are shared by the options and the presets. */
+  CHECK_THROWS(parser.add_preset("-j", {"-O"}));
+  CHECK_THROWS(parser.add_preset("--fast", {"-O"}));
+  CHECK_THROWS(parser.add_option("--quick", "quick"));
+  CHECK_THROWS(parser.add_passthrough("--fast", 0));
+  CHECK_THROWS(parser.add_preset("--loop", {"--loop"}));
+
+  parser.parse(false, false);
+  CHECK(parser.find("optimize"));
+  CHECK(parser.get<int>("jobs") == 8);
+  CHECK(parser.get<std::string>("file") == "file.txt");
+
+  /** The tokens refer to the elements of the presets. */
+  CHECK_THROWS(parser.add_preset("--slow", {"-j", "1"}));
+  parser.resume(false, false);
+  CHECK(parser.get<int>("jobs") == 8);
+
+  /** A copy expands the presets again from its own elements. */
+  auto original = new argparse::argparse(3, argv, "", false);
+  original->add_argument("file", argparse::value_type::String);
+  original->add_option("-j", "jobs", argparse::value_type::Integer, 1);
+  original->add_option("-O", "optimize");
+  original->add_preset("--fast", {"-O", "-j", "8"});
+  original->prescan({"jobs"});
+  argparse::argparse copy(*original);
+  argparse::argparse assigned(3, argv, "", false);
+  assigned = *original;
+  delete original;
+  copy.parse(false, false);
+  CHECK(copy.get<int>("jobs") == 8);
+  assigned.resume(false, false);
+  CHECK(assigned.find("optimize"));
+  return CHECK_RESULT();
+}
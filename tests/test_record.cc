@@ -0,0 +1,78 @@
+/***
+ * @brief Tests of the records of invocations
+ *
+ * This code is licensed under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include "../argparse.h"
+#include "check.h"
+
+int
+main(void)
+{
+  const char* argv[] = {"app", "-n", "42", "-s", "odd", "f.txt"};
+  argparse::argparse parser(6, argv, "", false);
+  parser.add_argument("file", argparse::value_type::String);
+  parser.add_option("-n", "num", argparse::value_type::Integer, 1);
+  parser.add_option("-s", "str", argparse::value_type::String, 1);
+
+  /** The fingerprint is updated when the arguments are modified. */
+  const uint64_t fingerprint = parser.fingerprint();
+  CHECK(parser.fingerprint() == fingerprint);
+  parser.set_choices("str", {"odd", "even"});
+  CHECK(parser.fingerprint() != fingerprint);
+  parser.parse(false, false);
+
+  char path[] = "/tmp/argparse_recordXXXXXX";
+  const int fd = mkstemp(path);
+  CHECK(fd >= 0);
+  parser.record(fd, 0);
+  const char* next[] = {"app", "-s", "even", "g.txt"};
+  parser.parse(4, next, false, false);
+  parser.record(fd, 1);
+  const off_t size = lseek(fd, 0, SEEK_END);
+  CHECK(size > 0 && size%8 == 0);
+
+  /** The log is read into an aligned buffer and replayed in place. */
+  std::vector<uint64_t> buffer((size+7)/8);
+  CHECK(pread(fd, buffer.data(), size, 0) == size);
+  close(fd);
+  unlink(path);
+  const char* log = reinterpret_cast<const char*>(buffer.data());
+  size_t p = parser.replay(log, size);
+  CHECK(p%8 == 0);
+  CHECK(parser.get<int>("num") == 42);
+  CHECK(parser.get<std::string>("file") == "f.txt");
+  p += parser.replay(log+p, size-p);
+  CHECK(p == (size_t)size);
+  CHECK(parser.get<std::string>("str") == "even");
+  CHECK(reinterpret_cast<const argparse::record_header*>(log)->status == 0);
+
+  /** A misaligned or truncated record is rejected. */
+  std::vector<uint64_t> shifted(buffer.size()+1);
+  std::memcpy(reinterpret_cast<char*>(shifted.data())+1, log, size);
+  CHECK_THROWS(parser.replay(reinterpret_cast<char*>(shifted.data())+1, size));
+  CHECK_THROWS(parser.replay(log, 16));
+  CHECK_THROWS(parser.replay(log, p/2));
+
+  /** A record of other arguments is rejected. */
+  parser.set_default("num", {"1"});
+  CHECK_THROWS(parser.replay(log, size));
+
+  /** A corrupted record is rejected or replayed without a crash. */
+  parser.set_default("num", {});
+  parser.set_choices("str", {"odd", "even"});
+  for (size_t i=0; i<(size_t)size; i++) {
+    std::vector<uint64_t> broken(buffer);
+    reinterpret_cast<char*>(broken.data())[i] ^= 0x5a;
+    try {
+      parser.replay(broken.data(), size);
+    } catch (std::runtime_error&) { }
+  }
+
+  return CHECK_RESULT();
+}
@@ -0,0 +1,76 @@
+/***
+ * @brief Tests of the reuse of a parser instance
+ *
+ * This code is licensed under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#include <cstdlib>
+#include <new>
+#include <string>
+#include "../argparse.h"
+#include "check.h"
+
+/** The number of the allocations */
+static size_t allocations = 0;
+
+void*
+operator new(std::size_t n)
+{
+  allocations++;
+  void* p = std::malloc(n?n:1);
+  if (p == nullptr) throw std::bad_alloc();
+  return p;
+}
+
+void
+operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+void
+operator delete(void* p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+int
+main(void)
+{
+  const char* argv[] = {"tool"};
+  argparse::argparse parser(1, argv, "", false);
+  parser.add_option(argparse::args{"-n", "--num"}, "num",
+                    argparse::value_type::Integer, 1);
+  parser.add_option("-r", "ratio", argparse::value_type::Float, 2);
+  parser.add_option("-b", "flag", argparse::value_type::Bool, 0);
+  parser.add_option("-s", "strings", argparse::value_type::String,
+                    argparse::variable_args);
+  parser.add_argument("input", argparse::value_type::String);
+  parser.add_argument("rest", argparse::value_type::Integer,
+                      argparse::variable_args);
+
+  const char* first[] = {"tool", "-n", "1", "-r", "0.5", "1.5", "-b",
+                         "in.txt", "1", "2", "3", "-s", "a", "b"};
+  const char* second[] = {"tool", "--num", "2", "-s", "c", "d", "-b",
+                          "-r", "2.5", "3.5", "out.txt", "4", "5", "6"};
+  parser.parse(14, first, false, false);
+  parser.parse(14, second, false, false);
+
+  /** The steady state allocates no memory. */
+  allocations = 0;
+  for (int i=0; i<8; i++) {
+    parser.parse(14, (i%2)?second:first, false, false);
+    CHECK(parser.get<int>("num") == 1+(i%2));
+  }
+  CHECK(allocations == 0);
+  CHECK(parser.get<std::string>("input") == "out.txt");
+  CHECK(parser.getall<int>("rest").size() == 3);
+
+  /** The values are cleared by reset(). */
+  parser.reset();
+  parser.parse(4, first+5, false, false);
+  CHECK(!parser.find("num"));
+  CHECK(parser.get<bool>("flag"));
+  return CHECK_RESULT();
+}
@@ -0,0 +1,95 @@
+/***
+ * @brief Tests of the response files
+ *
+ * This code is licensed under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "../argparse.h"
+#include "check.h"
+
+/** The directory of the response files */
+static std::string directory;
+
+/** Write a response file and return the element referring to it */
+static std::string
+write(const std::string& name, const std::string& text)
+{
+  const std::string path = directory + "/" + name;
+  FILE* fp = fopen(path.c_str(), "w");
+  fputs(text.c_str(), fp);
+  fclose(fp);
+  return "@" + path;
+}
+
+/** Parse a command line and return the positional arguments */
+static std::vector<std::string>
+parse(argparse::argparse& parser, const std::vector<std::string>& line)
+{
+  std::vector<const char*> argv{"tool"};
+  for (auto& e : line) argv.push_back(e.c_str());
+  parser.parse(argv.size(), argv.data(), false, false);
+  return parser.getall<std::string>("files");
+}
+
+int
+main(void)
+{
+  char temp[] = "/tmp/argparse_responsesXXXXXX";
+  CHECK(mkdtemp(temp) != nullptr);
+  directory = temp;
+  const char* argv[] = {"tool"};
+  argparse::argparse parser(1, argv, "", false);
+  parser.add_option("-n", "num", argparse::value_type::Integer, 1);
+  parser.add_argument("files", argparse::value_type::String, -1);
+  parser.set_response_files(true);
+
+  /** The files are spliced depth-first in the order of the inputs. */
+  const std::string b = write("b.rsp", "y 'z w'\n");
+  const std::string a = write("a.rsp", "-n 1 " + b + " x");
+  auto files = parse(parser, {a, "last", b});
+  CHECK(parser.get<int>("num") == 1);
+  CHECK((files == std::vector<std::string>{"y", "z w", "x", "last",
+                                           "y", "z w"}));
+
+  /** A copy loads the files again. */
+  auto original = new argparse::argparse(parser);
+  parse(*original, {b});
+  argparse::argparse copy(*original);
+  delete original;
+  CHECK(parse(copy, {a}) == (std::vector<std::string>{"y", "z w", "x"}));
+
+  /** More files than the concurrent tasks keep their order. */
+  std::vector<std::string> line, expected;
+  for (int i=0; i<40; i++) {
+    const std::string e = "e" + std::to_string(i);
+    const std::string inner = write("inner" + std::to_string(i) + ".rsp", e);
+    line.push_back(write("outer" + std::to_string(i) + ".rsp", inner + " ."));
+    expected.push_back(e);
+    expected.push_back(".");
+  }
+  CHECK(parse(parser, line) == expected);
+
+  /** A circular reference and a missing file are errors. */
+  const std::string c = directory + "/c.rsp";
+  const std::string d = write("d.rsp", "@" + c);
+  write("c.rsp", d);
+  CHECK_THROWS(parse(parser, {"@" + c}));
+  CHECK_THROWS(parse(parser, {"x", "@" + directory + "/missing.rsp"}));
+  const std::string self = write("self.rsp", "a @" + directory + "/self.rsp");
+  CHECK_THROWS(parse(parser, {self}));
+
+  /** An unterminated quote is an error. */
+  CHECK_THROWS(parse(parser, {write("quote.rsp", "'open")}));
+
+  /** An element `@` alone is not a reference. */
+  CHECK((parse(parser, {"@"}) == std::vector<std::string>{"@"}));
+
+  std::string command = "rm -rf " + directory;
+  CHECK(system(command.c_str()) == 0);
+  return CHECK_RESULT();
+}
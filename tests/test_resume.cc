@@ -0,0 +1,51 @@
+/***
+ * @brief Tests of the continuation after extending the arguments
+ *
+ * This code is licensed under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#include <string>
+#include "../argparse.h"
+#include "check.h"
+
+int
+main(void)
+{
+  const char* argv[] = {"tool", "-c", "a.conf", "-r", "30", "in.mp4",
+                        "-x", "3", "-q", "out.mp4"};
+  argparse::argparse parser(10, argv, "", false);
+  parser.add_option("-c", "config", argparse::value_type::String);
+  parser.add_argument("input", argparse::value_type::String);
+  parser.add_argument("output", argparse::value_type::String);
+  parser.add_scoped_option("-r", "rate", argparse::value_type::Integer, 1,
+                           "input", argparse::scope_type::Next);
+
+  /** The unknown options are taken as positional arguments. */
+  parser.parse(false, false);
+  CHECK(parser.get<std::string>("output") == "-x");
+  parser.add_option("-x", "extra", argparse::value_type::Integer);
+  parser.resume(false, false);
+  CHECK(parser.get<int>("extra") == 3);
+  CHECK(parser.get<std::string>("output") == "-q");
+
+  /** The positional arguments are assigned again. */
+  parser.add_option("-q", "quiet", argparse::value_type::Bool, 0);
+  parser.resume(false, false);
+  CHECK(parser.get<std::string>("config") == "a.conf");
+  CHECK(parser.get<int>("extra") == 3);
+  CHECK(parser.get<bool>("quiet"));
+  CHECK(parser.get<std::string>("input") == "in.mp4");
+  CHECK(parser.get<std::string>("output") == "out.mp4");
+  CHECK(parser.occurrences("input") == 1);
+  CHECK(parser.get_scoped<int>("rate", 0) == 30);
+
+  /** A new option never takes the elements already claimed. */
+  parser.add_option("-o", "output-file", argparse::value_type::String);
+  parser.resume(false, false);
+  CHECK(!parser.find("output-file"));
+  CHECK(parser.occurrences("input") == 1);
+  CHECK(parser.get_scoped<int>("rate", 0) == 30);
+  CHECK(parser.get<std::string>("output") == "out.mp4");
+  return CHECK_RESULT();
+}
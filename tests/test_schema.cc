@@ -0,0 +1,61 @@
+/***
+ * @brief Tests of the schema files
+ *
+ * This code is licensed under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#include <sstream>
+#include "../argparse.h"
+#include "check.h"
+
+/** Load a schema with an option of the given nargs */
+static void
+load(const char* nargs)
+{
+  const char* argv[] = {"tool"};
+  argparse::argparse parser(1, argv, "", false);
+  std::istringstream schema(std::string("{\"options\": [{\"directives\": "
+                                        "[\"-n\"], \"name\": \"n\", "
+                                        "\"type\": \"integer\", \"nargs\": ")
+                            + nargs + "}]}");
+  parser.load_schema(schema);
+}
+
+int
+main(void)
+{
+  const char* argv[] = {"tool", "-m", "slow", "a", "b"};
+  argparse::argparse parser(5, argv, "", false);
+  std::istringstream schema(R"({
+    "description": "Sample program",
+    "options": [
+      {"directives": ["-m", "--mode"], "name": "mode", "type": "string",
+       "default": "fast", "choices": ["fast", "slow"]},
+      {"directives": ["-v"], "name": "verbose"}
+    ],
+    "arguments": [{"name": "files", "type": "string", "nargs": -1}]
+  })");
+  parser.load_schema(schema);
+  parser.parse(false, false);
+  CHECK(parser.get<std::string>("mode") == "slow");
+  CHECK(!parser.find("verbose"));
+  CHECK(parser.getall<std::string>("files").size() == 2);
+
+  /** The schema written back defines the same arguments. */
+  std::ostringstream dumped;
+  parser.dump_schema(dumped);
+  argparse::argparse copy(5, argv, "", false);
+  std::istringstream again(dumped.str());
+  copy.load_schema(again);
+  CHECK(copy.fingerprint() == parser.fingerprint());
+
+  /** The number of the elements should be a 16-bit integer. */
+  load("2");
+  CHECK_THROWS(load("1.5"));
+  CHECK_THROWS(load("1e9"));
+  CHECK_THROWS(load("99999999999999999999"));
+  CHECK_THROWS(load("40000"));
+  CHECK_THROWS(load("-"));
+  return CHECK_RESULT();
+}
@@ -0,0 +1,94 @@
+/***
+ * @brief Tests of the scoped options
+ *
+ * This code is licensed under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#include <string>
+#include <vector>
+#include "../argparse.h"
+#include "check.h"
+
+int
+main(void)
+{
+  const char* argv[] = {"tool", "-r", "30", "-i", "a.mp4",
+                        "--rate", "60", "-i", "b.mp4", "-i", "c.mp4"};
+  argparse::argparse parser(11, argv, "", false);
+  parser.add_option("-i", "input", argparse::value_type::String);
+  parser.add_scoped_option(argparse::args{"-r", "--rate"}, "rate",
+                           argparse::value_type::Integer, 1, "input",
+                           argparse::scope_type::Next, "frame rate.");
+
+  /** A registered name would share the slot with the scoped option. */
+  CHECK_THROWS(parser.add_scoped_option("-x", "rate",
+                                        argparse::value_type::Integer, 1,
+                                        "input"));
+  CHECK_THROWS(parser.add_scoped_option("-y", "input",
+                                        argparse::value_type::Integer, 1,
+                                        "input"));
+  CHECK_THROWS(parser.add_scoped_option("-z", "size",
+                                        argparse::value_type::Integer, 1,
+                                        "output"));
+  CHECK_THROWS(parser.add_scoped_option("-w", "width",
+                                        argparse::value_type::Integer, 1,
+                                        "rate"));
+
+  parser.parse(false, false);
+  CHECK(parser.occurrences("input") == 3);
+  CHECK(parser.get_scoped<std::string>("input", 1) == "b.mp4");
+  CHECK(parser.get_scoped<int32_t>("rate", 0) == 30);
+  CHECK(parser.get_scoped<int32_t>("rate", 1) == 60);
+  CHECK(parser.get_scoped<int32_t>("rate", 2, 25) == 25);
+  CHECK(parser.get<int32_t>("rate") == 30);
+
+  /** The command line is regenerated for each occurrence. */
+  argparse::argv_buffer line;
+  parser.serialize(line);
+  const std::vector<std::string> expected{"tool", "-r", "30", "-i", "a.mp4",
+                                          "-r", "60", "-i", "b.mp4",
+                                          "-i", "c.mp4"};
+  CHECK((std::vector<std::string>(line.argv(), line.argv()+line.argc())
+         == expected));
+  argparse::argparse again(parser);
+  again.parse(line.argc(), const_cast<const char**>(line.argv()),
+              false, false);
+  CHECK(again.occurrences("input") == 3);
+  CHECK(again.get_scoped<int32_t>("rate", 1) == 60);
+  CHECK(again.get_scoped<int32_t>("rate", 2, 25) == 25);
+  /** The occurrences are not stored in a snapshot. */
+  std::vector<char> snapshot;
+  CHECK_THROWS(parser.snapshot(snapshot));
+
+  /** A positional anchor takes the occurrences at its position. */
+  const char* files[] = {"tool", "-v", "in.mp4", "-c", "h264", "out.mp4",
+                         "-c", "vp9", "log.txt"};
+  argparse::argparse positional(9, files, "", false);
+  positional.add_option("-v", "verbose", argparse::value_type::Bool, 0);
+  positional.add_argument("outputs", argparse::value_type::String, 2);
+  positional.add_argument("log", argparse::value_type::String);
+  positional.add_scoped_option("-c", "codec", argparse::value_type::String,
+                               1, "outputs", argparse::scope_type::Previous);
+  positional.parse(false, false);
+  positional.serialize(line);
+  const std::vector<std::string> canonical{"tool", "-v", "in.mp4", "-c",
+                                           "h264", "out.mp4", "-c", "vp9",
+                                           "log.txt"};
+  CHECK((std::vector<std::string>(line.argv(), line.argv()+line.argc())
+         == canonical));
+
+  /** A positional value never follows a variable number of values. */
+  const char* meta[] = {"tool", "-m", "a", "b", "-v", "in.mp4", "log.txt"};
+  argparse::argparse open(7, meta, "", false);
+  open.add_option("-v", "verbose", argparse::value_type::Bool, 0);
+  open.add_argument("input", argparse::value_type::String);
+  open.add_argument("log", argparse::value_type::String);
+  open.add_scoped_option("-m", "meta", argparse::value_type::String,
+                         argparse::variable_args, "input",
+                         argparse::scope_type::Next);
+  open.parse(false, false);
+  CHECK(open.getall_scoped<std::string>("meta", 0).size() == 2);
+  CHECK_THROWS(open.serialize(line));
+  return CHECK_RESULT();
+}
@@ -0,0 +1,97 @@
+/***
+ * @brief Tests of the canonical command lines
+ *
+ * This code is licensed under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#include <random>
+#include <string>
+#include <vector>
+#include "../argparse.h"
+#include "check.h"
+
+/** Return the elements of a command line */
+static std::vector<std::string>
+elements(const argparse::argv_buffer& line)
+{
+  return std::vector<std::string>(line.argv(), line.argv()+line.argc());
+}
+
+/** Define the arguments */
+static void
+define(argparse::argparse& parser)
+{
+  parser.add_option(argparse::args{"-n", "--num"}, "num",
+                    argparse::value_type::Integer, 1);
+  parser.add_option("-p", "pair", argparse::value_type::String, 2);
+  parser.add_option("-b", "flag", argparse::value_type::Bool, 0);
+  parser.add_option("-v", "values", argparse::value_type::Float,
+                    argparse::variable_args);
+  parser.add_argument("input", argparse::value_type::String);
+  parser.add_argument("rest", argparse::value_type::String,
+                      argparse::variable_args);
+}
+
+int
+main(void)
+{
+  const char* argv[] = {"tool", "-v", "1.5", "2", "-b", "in", "--num", "3",
+                        "-p", "x", "y", "a", "b"};
+  argparse::argparse parser(13, argv, "", false);
+  define(parser);
+  argparse::argv_buffer line;
+  CHECK_THROWS(parser.serialize(line));
+
+  /**
+   * The switches, the options, the positional arguments and the options
+   * with a variable number of values are emitted in this order.
+   */
+  parser.parse(false, false);
+  parser.serialize(line);
+  CHECK((elements(line) == std::vector<std::string>{
+        "tool", "-b", "-n", "3", "-p", "x", "y", "in", "a", "b",
+        "-v", "1.5", "2"}));
+  CHECK(line.argv()[line.argc()] == nullptr);
+
+  /** Only the given names are emitted. */
+  parser.serialize(line, {"num", "rest"});
+  CHECK((elements(line) == std::vector<std::string>{
+        "tool", "-n", "3", "a", "b"}));
+
+  /** The command lines are parsed into the same values. */
+  const char* pool[] = {"-n", "--num", "-p", "-b", "-v", "1", "-2", "0.5",
+                        "x", "y", "z"};
+  std::mt19937 rng(20261018);
+  for (int t=0; t<2000; t++) {
+    std::vector<const char*> random{"tool"};
+    const size_t n = rng()%10;
+    for (size_t i=0; i<n; i++) random.push_back(pool[rng()%11]);
+    argparse::argparse first((int)random.size(), random.data(), "", false);
+    define(first);
+    try {
+      first.parse(false, false);
+    } catch (std::runtime_error&) {
+      continue;
+    }
+    first.serialize(line);
+    argparse::argparse second(line.argc(),
+                              const_cast<const char**>(line.argv()), "",
+                              false);
+    define(second);
+    second.parse(false, false);
+    for (auto name : {"num", "pair", "flag", "values", "input", "rest"}) {
+      if (first.find(name) != second.find(name)
+          || (first.find(name) && first.getall<std::string>(name)
+              != second.getall<std::string>(name))) {
+        fprintf(stderr, "differ in \"%s\":", name);
+        for (size_t i=1; i<random.size(); i++)
+          fprintf(stderr, " '%s'", random[i]);
+        fprintf(stderr, "\n");
+        check_failures++;
+      }
+    }
+    if (check_failures > 20) break;
+  }
+  return CHECK_RESULT();
+}
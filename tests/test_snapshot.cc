@@ -0,0 +1,46 @@
+/***
+ * @brief Tests of the snapshots of parsed values
+ *
+ * This code is licensed under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#include "../argparse.h"
+#include "check.h"
+
+int
+main(void)
+{
+  const char* argv[] = {"app", "-n", "42", "-x", "1.5", "2.5", "-b", "f.txt"};
+  argparse::argparse parser(8, argv, "", false);
+  parser.add_argument("file", argparse::value_type::String);
+  parser.add_option("-n", "num", argparse::value_type::Integer, 1);
+  parser.add_option("-x", "xs", argparse::value_type::Float, 2);
+  parser.add_option("-b", "flag");
+  parser.parse(false, false);
+
+  std::vector<char> buffer;
+  parser.snapshot(buffer);
+  argparse::snapshot_view view(buffer.data(), buffer.size());
+  CHECK(view.get<int32_t>("num") == 42);
+  CHECK(view.get<uint16_t>("num") == 42);
+  CHECK(view.get<std::string>("num") == "42");
+  CHECK(view.getall<double>("xs").size() == 2);
+  CHECK(view.getall<double>("xs")[1] == 2.5);
+  CHECK(view.get<bool>("flag"));
+  CHECK(view.get<std::string>("file") == "f.txt");
+  CHECK(!view.find("missing"));
+  CHECK(view.get<int32_t>("missing", 7) == 7);
+  CHECK_THROWS(view.get<int32_t>("file"));
+
+  /** A truncated snapshot is rejected. */
+  CHECK_THROWS(argparse::snapshot_view(buffer.data(), 8));
+
+#ifdef __linux__
+  const int fd = parser.publish();
+  auto attached = argparse::snapshot_view::attach(fd);
+  CHECK(attached.get<int64_t>("num") == 42);
+  close(fd);
+#endif
+  return CHECK_RESULT();
+}
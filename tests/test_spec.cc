@@ -0,0 +1,112 @@
+/***
+ * @brief Tests of the cache files of the registered arguments
+ *
+ * This code is licensed under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+#include <unistd.h>
+#include "../argparse.h"
+#include "check.h"
+
+/** Register the arguments used in the tests */
+static void
+define(argparse::argparse& p)
+{
+  p.add_option(argparse::args{"-i", "--input"}, "input",
+               argparse::value_type::String);
+  p.add_scoped_option("-r", "rate", argparse::value_type::Integer, 1,
+                      "input", argparse::scope_type::Previous);
+  p.add_option("-m", "mode", argparse::value_type::String);
+  p.set_default("mode", {"fast"});
+  p.set_choices("mode", {"fast", "slow"});
+  p.add_exit_option(argparse::args{"--version"}, "version");
+  p.add_preset("--quick", {"-m", "fast"});
+  p.add_argument("files", argparse::value_type::String, -1);
+}
+
+/** Read a whole file */
+static std::vector<char>
+slurp(const char* path)
+{
+  std::vector<char> data;
+  FILE* fp = fopen(path, "rb");
+  if (fp == nullptr) return data;
+  char chunk[4096];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), fp)) > 0)
+    data.insert(data.end(), chunk, chunk+n);
+  fclose(fp);
+  return data;
+}
+
+/** Write a cache file with the hash updated for the contents */
+static void
+forge(const char* path, std::vector<char> data, const char* key)
+{
+  const size_t at = offsetof(argparse::spec_cache_header, key);
+  std::memset(data.data()+at, 0, sizeof(uint64_t));
+  const uint64_t h = argparse::fnv1a(data.data(), data.size());
+  const uint64_t k = argparse::fnv1a(key, std::strlen(key), h);
+  std::memcpy(data.data()+at, &k, sizeof(k));
+  FILE* fp = fopen(path, "wb");
+  fwrite(data.data(), 1, data.size(), fp);
+  fclose(fp);
+}
+
+int
+main(void)
+{
+  const std::string path = "test_spec." + std::to_string((long)getpid());
+  const char* argv[] = {"tool", "-i", "a.mp4", "-r", "30", "--quick",
+                        "x", "y"};
+  argparse::argparse origin(8, argv, "sample", false);
+  define(origin);
+  origin.save_spec(path, "v1");
+
+  argparse::argparse cached(8, argv, "", false);
+  CHECK(cached.load_spec(path, "v1"));
+  CHECK(cached.fingerprint() == origin.fingerprint());
+  cached.parse(false, false);
+  CHECK(cached.get_scoped<int32_t>("rate", 0) == 30);
+  CHECK(cached.get<std::string>("mode") == "fast");
+  CHECK(cached.getall<std::string>("files").size() == 2);
+
+  /** A different key, a modified byte or a truncation is rejected. */
+  argparse::argparse other(8, argv, "", false);
+  CHECK(!other.load_spec(path, "v2"));
+  const std::vector<char> data = slurp(path.c_str());
+  std::vector<char> modified(data);
+  modified[modified.size()/2] ^= 1;
+  FILE* fp = fopen(path.c_str(), "wb");
+  fwrite(modified.data(), 1, modified.size(), fp);
+  fclose(fp);
+  CHECK(!other.load_spec(path, "v1"));
+  forge(path.c_str(), std::vector<char>(data.begin(), data.end()-8), "v1");
+  CHECK(!other.load_spec(path, "v1"));
+
+  /** Every word replaced by a large count is rejected without a throw. */
+  const size_t head = sizeof(argparse::spec_cache_header);
+  const size_t words = offsetof(argparse::spec_cache_header, size);
+  const uint32_t counts[] = {0xffffffffu, 0x7fffffffu, 0x10000u};
+  for (size_t p=words; p+4 <= data.size(); p+=4) {
+    for (auto c : counts) {
+      std::vector<char> broken(data);
+      std::memcpy(broken.data()+p, &c, sizeof(c));
+      forge(path.c_str(), broken, "v1");
+      argparse::argparse target(1, argv, "", false);
+      try {
+        target.load_spec(path, "v1");
+      } catch (...) {
+        fprintf(stderr, "thrown with %#x at byte %zu\n", c, p);
+        check_failures++;
+      }
+    }
+    if (p >= head+4096) break;
+  }
+  std::remove(path.c_str());
+  return CHECK_RESULT();
+}
@@ -0,0 +1,109 @@
+/***
+ * @brief Tests of the command lines parsed at compile time
+ *
+ * This code is licensed under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <string>
+#include "../argparse.h"
+#include "check.h"
+
+static constexpr argparse::static_option spec[] = {
+  {"-r", "rate", argparse::value_type::Integer, 1},
+  {"-v", "verbose", argparse::value_type::Bool, 0},
+  {"-t", "title", argparse::value_type::String, 1},
+  {"-s", "scale", argparse::value_type::Float, 1},
+};
+
+/** Compare the conversion at compile time with `scan_float()` */
+static void
+compare(const std::string& s)
+{
+  double expected(0.0);
+  char* end = nullptr;
+  const bool valid = argparse::scan_float(s.c_str(), expected)
+    && (std::strtod(s.c_str(), &end), *end == '\0') && !s.empty()
+    && s[0] != ' ';
+  bool converted(false);
+  double v(0.0);
+  try {
+    v = argparse::static_convert(argparse::value_type::Float,
+                                 s.c_str(), s.size()).real;
+    converted = true;
+  } catch (std::runtime_error&) { }
+  const bool same = (converted == valid)
+    && (!valid || (std::isnan(v)?std::isnan(expected)
+                   && std::signbit(v) == std::signbit(expected)
+                   : std::memcmp(&v, &expected, sizeof(v)) == 0));
+  if (!same) {
+    fprintf(stderr, "'%s': %s %a, expected %s %a\n", s.c_str(),
+            converted?"converted":"rejected", v,
+            valid?"converted":"rejected", expected);
+    check_failures++;
+  }
+}
+
+int
+main(void)
+{
+  constexpr auto embedded = argparse::static_parse<8>(spec,
+                                                      "-r 60 -v -t ''");
+  static_assert(embedded.integer("rate") == 60, "");
+  static_assert(embedded.find("verbose"), "");
+  static_assert(embedded.at("title").size == 0, "");
+
+  /** An empty element is compared by its length. */
+  CHECK_THROWS(argparse::static_parse<8>(spec, "\"\" -r 1"));
+  CHECK_THROWS(argparse::static_parse<8>(spec, "''"));
+  CHECK_THROWS(argparse::static_parse<8>(spec, "-r"));
+  CHECK_THROWS(argparse::static_parse<8>(spec, "-rate 1"));
+  CHECK(argparse::static_parse<8>(spec, "-t \"a b\"").at("title").size == 3);
+
+  /** The floats are correctly rounded. */
+  constexpr auto real = argparse::static_parse<8>(spec, "-s 0.3");
+  static_assert(real.real("scale") == 0.3, "");
+  static_assert(argparse::static_parse<8>(spec, "-s 0x10").real("scale")
+                == 16.0, "");
+  static_assert(argparse::static_parse<8>(spec, "-s 1.7976931348623157e308")
+                .real("scale") == 1.7976931348623157e308, "");
+  for (auto s : {"0.3", "3.14159", "9.87654321", "1.7976931348623157e308",
+                 "1.7976931348623159e308", "2.2250738585072014e-308",
+                 "2.2250738585072011e-308", "4.9406564584124654e-324",
+                 "0x1p-1074", "0x1.8p-1074", "0x1p-1075", "1e-400", "0e-400",
+                 "0x10", "0X1.fffffffffffffP1023", "0x1.fffffffffffff8p1023",
+                 "-0", "+.5", "1.", ".", "1e", "1e+", "0x", "0x.p1", "e5",
+                 "inf", "-Infinity", "nan", "-NaN(abc)", "nan(", "1.5x",
+                 "9007199254740993", "123456789012345678901234567890",
+                 "0.1e1000000", "1e-1000000", "00000.000001e6", ""})
+    compare(s);
+  std::mt19937_64 rng(20261018);
+  for (int t=0; t<20000 && check_failures<20; t++) {
+    /** The shortest, the exact and the noisy decimal forms */
+    uint64_t bits = rng();
+    double x;
+    std::memcpy(&x, &bits, sizeof(x));
+    if (std::isnan(x)) continue;
+    char buffer[1100];
+    snprintf(buffer, sizeof(buffer), "%.17g", x);
+    compare(buffer);
+    snprintf(buffer, sizeof(buffer), "%.*e", (int)(rng()%30), x);
+    compare(buffer);
+    snprintf(buffer, sizeof(buffer), "%a", x);
+    compare(buffer);
+    std::string digits(1+rng()%40, '0');
+    for (auto& c : digits) c = (char)('0'+rng()%10);
+    compare(digits + "e" + std::to_string((int)(rng()%700)-350));
+    compare("0." + digits);
+  }
+  /** A halfway case with many digits is broken by the last digit. */
+  compare("9007199254740993" + std::string(800, '0'));
+  compare("9007199254740993" + std::string(800, '0') + "1");
+  compare("4.9406564584124654417656879286822137236505980e-324");
+  compare("2.4703282292062327208828439643411068618252990130716238221279284"
+          "1250e-324");
+  return CHECK_RESULT();
+}
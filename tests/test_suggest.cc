@@ -0,0 +1,89 @@
+/***
+ * @brief Tests of the suggestions for misspelled directives
+ *
+ * This code is licensed under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#include <random>
+#include <string>
+#include <vector>
+#include "../argparse.h"
+#include "check.h"
+
+/** Calculate the Levenshtein distance by dynamic programming */
+static size_t
+reference(const std::string& s, const std::string& t)
+{
+  std::vector<size_t> row(t.size()+1);
+  for (size_t j=0; j<=t.size(); j++) row[j] = j;
+  for (size_t i=1; i<=s.size(); i++) {
+    size_t diagonal = row[0];
+    row[0] = i;
+    for (size_t j=1; j<=t.size(); j++) {
+      const size_t up = row[j];
+      row[j] = std::min(std::min(row[j], row[j-1])+1,
+                        diagonal+(s[i-1] == t[j-1]?0:1));
+      diagonal = up;
+    }
+  }
+  return row[t.size()];
+}
+
+int
+main(void)
+{
+  /** The bit-parallel distance agrees with the table on random pairs. */
+  std::mt19937 rng(20261018);
+  for (int t=0; t<20000; t++) {
+    const size_t alphabet = 2+rng()%4;
+    std::string s(1+rng()%64, 'a'), u(rng()%80, 'a');
+    for (auto& c : s) c = (char)('a'+rng()%alphabet);
+    for (auto& c : u) c = (char)('a'+rng()%alphabet);
+    uint64_t peq[256] = {0};
+    for (size_t i=0; i<s.size(); i++)
+      peq[(unsigned char)s[i]] |= (uint64_t)1<<i;
+    const size_t d = argparse::edit_distance(peq, s.size(), u.data(),
+                                              u.size());
+    if (d != reference(s, u)) {
+      fprintf(stderr, "distance of '%s' and '%s': %zu, expected %zu\n",
+              s.c_str(), u.c_str(), d, reference(s, u));
+      check_failures++;
+      if (check_failures > 20) break;
+    }
+  }
+
+  const char* argv[] = {"tool"};
+  argparse::argparse parser(1, argv, "", false);
+  parser.add_option(argparse::args{"-o", "--output"}, "output",
+                    argparse::value_type::String);
+  parser.add_option(argparse::args{"--outputs"}, "outputs",
+                    argparse::value_type::String);
+  parser.add_option(argparse::args{"--input"}, "input",
+                    argparse::value_type::String);
+  parser.add_option(argparse::args{"--verbose"}, "verbose",
+                    argparse::value_type::Bool, 0);
+
+  /** The suggestions are sorted by the distance. */
+  CHECK((parser.suggest("--ouptut") == argparse::args{"--output"}));
+  CHECK((parser.suggest("--outputz")
+         == argparse::args{"--output", "--outputs"}));
+  CHECK((parser.suggest("--outputz", 1) == argparse::args{"--output"}));
+  CHECK((parser.suggest("--verbos") == argparse::args{"--verbose"}));
+  /** An exact match, a distant element and a long element are skipped. */
+  CHECK(parser.suggest("--input").empty());
+  CHECK(parser.suggest("--quiet").empty());
+  CHECK(parser.suggest(std::string(65, 'x')).empty());
+
+  /** The suggestions are reported with an unknown option. */
+  parser.add_argument("count", argparse::value_type::Integer);
+  const char* typo[] = {"tool", "--verbos"};
+  try {
+    parser.parse(2, typo, false, false);
+    check_failures++;
+  } catch (std::runtime_error& e) {
+    CHECK(std::string(e.what()).find("did you mean '--verbose'?")
+          != std::string::npos);
+  }
+  return CHECK_RESULT();
+}
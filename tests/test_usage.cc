@@ -0,0 +1,58 @@
+/***
+ * @brief Tests of the usage counters
+ *
+ * This code is licensed under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#include "../argparse.h"
+#include "check.h"
+
+/** Obtain the counter of an argument */
+static argparse::usage_counter
+counter(const argparse::argparse& parser, const argparse::arg& name)
+{
+  for (auto& c : parser.usage())
+    if (c.name == name) return c;
+  return argparse::usage_counter{name, 0, 0};
+}
+
+int
+main(void)
+{
+  const char* argv[] = {"app", "-c", "a.conf", "-n", "1", "f.txt"};
+  argparse::argparse parser(6, argv, "", false);
+  parser.add_option("-c", "config", argparse::value_type::String, 1);
+  parser.set_telemetry(true);
+
+  /** The options taken by prescan() are counted once. */
+  parser.prescan({"config"});
+  CHECK(counter(parser, "config").given == 1);
+  parser.add_option("-n", "num", argparse::value_type::Integer, 1);
+  parser.add_argument("file", argparse::value_type::String);
+  parser.resume(false, false);
+  CHECK(counter(parser, "config").given == 1);
+  CHECK(counter(parser, "num").given == 1);
+  CHECK(counter(parser, "file").given == 1);
+
+  parser.prescan({"config"});
+  parser.parse(false, false);
+  CHECK(counter(parser, "config").given == 2);
+  CHECK(counter(parser, "num").given == 2);
+  parser.get<int>("num");
+  CHECK(counter(parser, "num").read == 1);
+
+  /** A copy starts with the current counters and counts separately. */
+  argparse::argparse copy(parser);
+  CHECK(counter(copy, "num").given == 2);
+  copy.get<int>("num");
+  CHECK(counter(copy, "num").read == 2);
+  CHECK(counter(parser, "num").read == 1);
+  copy = parser;
+  CHECK(counter(copy, "num").read == 1);
+
+  parser.set_telemetry(false);
+  CHECK(parser.usage().empty());
+
+  return CHECK_RESULT();
+}
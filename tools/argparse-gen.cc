@@ -0,0 +1,51 @@
+/***
+ * @brief A generator of specialized parsers from JSON schemas
+ *
+ * This code is licensed under the MIT License.
+ * https://opensource.org/licenses/MIT
+ *
+ * Usage: argparse-gen [-n namespace] [-o output] schema.json
+ */
+
+#include <fstream>
+#include "../argparse.h"
+
+int
+main(int argc, char** argv)
+{
+  argparse::argparse parser(argc, argv,
+                            "Generate a C++ parser from a JSON schema.");
+  parser.add_option(argparse::args{"-n","--namespace"}, "namespace",
+                    argparse::value_type::String, 1,
+                    "The namespace of the generated parser.");
+  parser.add_option(argparse::args{"-o","--output"}, "output",
+                    argparse::value_type::String, 1,
+                    "The output file. The source is written to stdout "
+                    "if not given.");
+  parser.add_argument("schema", argparse::value_type::String,
+                      "The JSON schema of the arguments.");
+  parser.parse();
+
+  std::ifstream schema(parser.get<std::string>("schema"));
+  if (!schema) {
+    fprintf(stderr, "error: cannot open %s\n",
+            parser.get<std::string>("schema").c_str());
+    return EXIT_FAILURE;
+  }
+  try {
+    const char* app[] = {"app"};
+    argparse::argparse spec(1, app, "", true);
+    spec.load_schema(schema);
+    const std::string ns = parser.get<std::string>("namespace", "cli");
+    if (parser.find("output")) {
+      std::ofstream output(parser.get<std::string>("output"));
+      spec.generate(output, ns);
+    } else {
+      spec.generate(std::cout, ns);
+    }
+  } catch (std::runtime_error& e) {
+    fprintf(stderr, "error: %s\n", e.what());
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}